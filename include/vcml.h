@@ -17,11 +17,15 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/range.h"
 #include "vcml/core/peq.h"
+#include "vcml/core/mpsc.h"
+#include "vcml/core/sensor.h"
+#include "vcml/core/checkpoint.h"
 #include "vcml/core/command.h"
 #include "vcml/core/module.h"
 #include "vcml/core/component.h"
 #include "vcml/core/register.h"
 #include "vcml/core/peripheral.h"
+#include "vcml/core/regmap.h"
 #include "vcml/core/processor.h"
 #include "vcml/core/system.h"
 #include "vcml/core/setup.h"
@@ -55,6 +59,7 @@
 #include "vcml/ui/video.h"
 #include "vcml/ui/display.h"
 #include "vcml/ui/console.h"
+#include "vcml/ui/shmfb.h"
 
 #include "vcml/protocols/tlm.h"
 #include "vcml/protocols/gpio.h"
@@ -126,8 +131,10 @@
 #include "vcml/models/virtio/console.h"
 #include "vcml/models/virtio/input.h"
 
+#include "vcml/models/meta/lazy.h"
 #include "vcml/models/meta/loader.h"
 #include "vcml/models/meta/simdev.h"
+#include "vcml/models/meta/shmbridge.h"
 #include "vcml/models/meta/throttle.h"
 
 #include "vcml/models/opencores/ompic.h"
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_CHECKPOINT_H
+#define VCML_CHECKPOINT_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+#include "vcml/logging/logger.h"
+#include "vcml/properties/property_base.h"
+
+namespace vcml {
+
+// Serialization visitor handed to module::serialize. The same calls are used
+// for saving and restoring: while saving, values are read and recorded, while
+// restoring, values that are found in the checkpoint are written back. Keys
+// are relative to the object currently being visited.
+class checkpoint
+{
+public:
+    enum mode : int {
+        CHECKPOINT_SAVE,
+        CHECKPOINT_RESTORE,
+    };
+
+    static constexpr size_t SPARSE_PAGE_SIZE = 4096;
+
+private:
+    mode m_mode;
+    string m_dir;
+    string m_scope;
+    vector<string> m_scopes;
+    sc_time m_time;
+    std::map<string, string> m_values;
+    size_t m_missing;
+
+    string key(const string& name) const;
+    string path(const string& name) const;
+
+    void load();
+
+public:
+    mode get_mode() const { return m_mode; }
+    bool is_saving() const { return m_mode == CHECKPOINT_SAVE; }
+    bool is_restoring() const { return m_mode == CHECKPOINT_RESTORE; }
+
+    const char* directory() const { return m_dir.c_str(); }
+    const char* scope() const { return m_scope.c_str(); }
+
+    // simulation time at which the checkpoint was taken
+    const sc_time& time() const { return m_time; }
+
+    // number of keys that were requested but not found while restoring
+    size_t missing() const { return m_missing; }
+
+    checkpoint(const string& dir, mode md);
+    virtual ~checkpoint() = default;
+
+    checkpoint() = delete;
+    checkpoint(const checkpoint&) = delete;
+
+    void enter(const sc_object& obj);
+    void leave();
+
+    bool has(const string& name) const;
+
+    bool value(const string& name, string& val);
+    bool blob(const string& name, void* data, size_t size);
+    bool sparse(const string& name, u8* data, size_t size);
+
+    template <typename T>
+    bool value(const string& name, T& val);
+
+    // properties the current configuration defines keep their configured
+    // value on restore unless force is set, e.g. for registers
+    bool prop(property_base& prop, bool force = false);
+
+    void commit();
+};
+
+template <typename T>
+inline bool checkpoint::value(const string& name, T& val) {
+    string str = is_saving() ? to_string<T>(val) : string();
+    if (!value(name, str))
+        return false;
+    if (is_restoring())
+        val = from_string<T>(str);
+    return true;
+}
+
+} // namespace vcml
+
+#endif
@@ -75,6 +75,12 @@ protected:
     virtual void gpio_transport(const gpio_target_socket& socket,
                                 gpio_payload& tx) override;
 
+    virtual void gpio_bulk_transport(const gpio_target_socket& socket,
+                                     gpio_bulk_payload& tx) override;
+
+    virtual void gpio_bulk_notify(const gpio_target_socket& socket,
+                                  u64 changed, gpio_vector base);
+
     virtual void gpio_notify(const gpio_target_socket& socket, bool state,
                              gpio_vector vector);
     virtual void gpio_notify(const gpio_target_socket& socket, bool state);
@@ -14,6 +14,7 @@
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/command.h"
+#include "vcml/core/checkpoint.h"
 
 #include "vcml/logging/logger.h"
 #include "vcml/tracing/tracer.h"
@@ -53,6 +54,18 @@ public:
     virtual void session_suspend();
     virtual void session_resume();
 
+    // saves or restores the state of this module, covers all properties and
+    // registers; models with additional state extend this
+    virtual void serialize(checkpoint& ckpt);
+
+    // called before the simulation forks to release host threads and
+    // resources, and in every child afterwards to set up its own; the child
+    // id starts at 1 and replaces any {fork} in fork_expand templates
+    virtual void fork_prepare();
+    virtual void fork_child(size_t id);
+
+    static string fork_expand(const string& tmpl, size_t id);
+
     bool execute(const string& name, ostream& os);
     bool execute(const string& name, const vector<string>& args, ostream& os);
 
@@ -0,0 +1,150 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_MPSC_H
+#define VCML_MPSC_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// Bounded lock-free queue for many producer threads and a single consumer
+// thread. All storage is allocated up front, push fails if the queue is full.
+template <typename T, size_t N>
+class mpsc_queue
+{
+private:
+    static_assert(N > 1 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    struct cell {
+        atomic<size_t> seq;
+        T data;
+    };
+
+    array<cell, N> m_cells;
+    alignas(64) atomic<size_t> m_head;
+    alignas(64) size_t m_tail;
+
+public:
+    mpsc_queue();
+    ~mpsc_queue() = default;
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    constexpr size_t capacity() const { return N; }
+
+    bool empty() const;
+
+    bool push(T&& val);
+    bool push(const T& val);
+    bool pop(T& val);
+
+    // emplace fills the next free cell in place and exchange swaps the
+    // oldest entry with val instead of moving it out; together they keep
+    // the storage held by T (e.g. buffers) circulating within the queue
+    template <typename FUNC>
+    bool emplace(FUNC&& fill);
+    bool exchange(T& val);
+
+    template <typename FUNC>
+    size_t drain(FUNC&& fn, size_t budget = SIZE_MAX);
+};
+
+template <typename T, size_t N>
+mpsc_queue<T, N>::mpsc_queue(): m_cells(), m_head(0), m_tail(0) {
+    for (size_t i = 0; i < N; i++)
+        m_cells[i].seq.store(i, std::memory_order_relaxed);
+}
+
+template <typename T, size_t N>
+inline bool mpsc_queue<T, N>::empty() const {
+    const cell& c = m_cells[m_tail & (N - 1)];
+    return c.seq.load(std::memory_order_acquire) != m_tail + 1;
+}
+
+template <typename T, size_t N>
+inline bool mpsc_queue<T, N>::push(T&& val) {
+    return emplace([&val](T& data) -> void { data = std::move(val); });
+}
+
+template <typename T, size_t N>
+template <typename FUNC>
+inline bool mpsc_queue<T, N>::emplace(FUNC&& fill) {
+    cell* c = nullptr;
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    while (true) {
+        c = &m_cells[pos & (N - 1)];
+        size_t seq = c->seq.load(std::memory_order_acquire);
+        ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+        if (diff < 0)
+            return false;
+
+        if (diff > 0) {
+            pos = m_head.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (m_head.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed))
+            break;
+    }
+
+    fill(c->data);
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, size_t N>
+inline bool mpsc_queue<T, N>::push(const T& val) {
+    T copy(val);
+    return push(std::move(copy));
+}
+
+template <typename T, size_t N>
+inline bool mpsc_queue<T, N>::pop(T& val) {
+    cell& c = m_cells[m_tail & (N - 1)];
+    if (c.seq.load(std::memory_order_acquire) != m_tail + 1)
+        return false;
+
+    val = std::move(c.data);
+    c.seq.store(m_tail + N, std::memory_order_release);
+    m_tail++;
+    return true;
+}
+
+template <typename T, size_t N>
+inline bool mpsc_queue<T, N>::exchange(T& val) {
+    cell& c = m_cells[m_tail & (N - 1)];
+    if (c.seq.load(std::memory_order_acquire) != m_tail + 1)
+        return false;
+
+    std::swap(val, c.data);
+    c.seq.store(m_tail + N, std::memory_order_release);
+    m_tail++;
+    return true;
+}
+
+template <typename T, size_t N>
+template <typename FUNC>
+inline size_t mpsc_queue<T, N>::drain(FUNC&& fn, size_t budget) {
+    size_t n = 0;
+    T val;
+    while (n < budget && pop(val)) {
+        fn(val);
+        n++;
+    }
+
+    return n;
+}
+
+} // namespace vcml
+
+#endif
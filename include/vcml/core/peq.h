@@ -16,12 +16,48 @@
 
 namespace vcml {
 
+template <typename T, typename = std::void_t<>>
+struct peq_hashable : std::false_type {};
+
+template <typename T>
+struct peq_hashable<
+    T, std::void_t<decltype(std::hash<T>()(std::declval<const T&>()))>>
+    : std::true_type {};
+
 template <typename T>
 class peq : public sc_object
 {
 private:
+    struct slot {
+        sc_time time;
+        u64 seq;
+        T payload;
+        size_t pos;
+    };
+
+    typedef vector<size_t> slot_list;
+    typedef std::conditional_t<peq_hashable<T>::value,
+                               unordered_map<T, slot_list>,
+                               vector<pair<T, slot_list>>>
+        index_type;
+
     sc_event m_event;
-    std::multimap<sc_time, T> m_schedule;
+    sc_time m_armed;
+    u64 m_seq;
+
+    vector<slot> m_slots;
+    vector<size_t> m_free;
+    vector<size_t> m_heap;
+    index_type m_index;
+
+    bool earlier(size_t a, size_t b) const;
+    void exchange(size_t a, size_t b);
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+    void remove(size_t pos);
+
+    slot_list* lookup(const T& payload);
+    void forget(const T& payload);
 
     void update();
 
@@ -34,23 +70,126 @@ public:
     void notify(const T& payload, const sc_time& delta);
     void cancel(const T& obj);
     void wait(T& obj);
+
+    size_t size() const { return m_heap.size(); }
 };
 
 template <typename T>
-inline void peq<T>::update() {
-    if (m_schedule.empty()) {
-        m_event.cancel();
+inline bool peq<T>::earlier(size_t a, size_t b) const {
+    const slot& sa = m_slots[a];
+    const slot& sb = m_slots[b];
+    if (sa.time != sb.time)
+        return sa.time < sb.time;
+    return sa.seq < sb.seq;
+}
+
+template <typename T>
+inline void peq<T>::exchange(size_t a, size_t b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_slots[m_heap[a]].pos = a;
+    m_slots[m_heap[b]].pos = b;
+}
+
+template <typename T>
+inline void peq<T>::sift_up(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!earlier(m_heap[pos], m_heap[parent]))
+            break;
+        exchange(pos, parent);
+        pos = parent;
+    }
+}
+
+template <typename T>
+inline void peq<T>::sift_down(size_t pos) {
+    size_t n = m_heap.size();
+    while (true) {
+        size_t next = pos;
+        size_t l = 2 * pos + 1;
+        size_t r = 2 * pos + 2;
+        if (l < n && earlier(m_heap[l], m_heap[next]))
+            next = l;
+        if (r < n && earlier(m_heap[r], m_heap[next]))
+            next = r;
+        if (next == pos)
+            break;
+        exchange(pos, next);
+        pos = next;
+    }
+}
+
+template <typename T>
+inline void peq<T>::remove(size_t pos) {
+    m_free.push_back(m_heap[pos]);
+
+    size_t last = m_heap.size() - 1;
+    if (pos != last) {
+        m_heap[pos] = m_heap[last];
+        m_slots[m_heap[pos]].pos = pos;
+    }
+
+    m_heap.pop_back();
+    if (pos < m_heap.size()) {
+        sift_down(pos);
+        sift_up(pos);
+    }
+}
+
+template <typename T>
+inline typename peq<T>::slot_list* peq<T>::lookup(const T& payload) {
+    if constexpr (peq_hashable<T>::value) {
+        auto it = m_index.find(payload);
+        return it != m_index.end() ? &it->second : nullptr;
+    } else {
+        for (auto& entry : m_index)
+            if (entry.first == payload)
+                return &entry.second;
+        return nullptr;
+    }
+}
+
+template <typename T>
+inline void peq<T>::forget(const T& payload) {
+    if constexpr (peq_hashable<T>::value) {
+        m_index.erase(payload);
     } else {
-        sc_time next = m_schedule.begin()->first;
-        m_event.notify(next - sc_time_stamp());
+        stl_remove_if(m_index, [&payload](const pair<T, slot_list>& e) {
+            return e.first == payload;
+        });
+    }
+}
+
+template <typename T>
+inline void peq<T>::update() {
+    if (m_heap.empty()) {
+        if (m_armed != SC_MAX_TIME)
+            m_event.cancel();
+        m_armed = SC_MAX_TIME;
+        return;
     }
+
+    // only re-arm the event if the earliest deadline has actually changed
+    const sc_time& next = m_slots[m_heap.front()].time;
+    if (next == m_armed)
+        return;
+
+    sc_time now = sc_time_stamp();
+    m_event.cancel();
+    m_event.notify(next > now ? next - now : SC_ZERO_TIME);
+    m_armed = next;
 }
 
 template <typename T>
 inline peq<T>::peq(const char* nm):
     sc_object(nm),
     m_event(mkstr("%s_event", basename()).c_str()),
-    m_schedule() {
+    m_armed(SC_MAX_TIME),
+    m_seq(0),
+    m_slots(),
+    m_free(),
+    m_heap(),
+    m_index() {
     // nothing to do
 }
 
@@ -62,35 +201,74 @@ inline void peq<T>::notify(const T& payload, double t, sc_time_unit tu) {
 template <typename T>
 inline void peq<T>::notify(const T& payload, const sc_time& delta) {
     sc_time t = sc_time_stamp() + delta;
-    auto range = m_schedule.equal_range(t);
-    for (auto it = range.first; it != range.second; it++)
-        if (it->second == payload)
-            return;
 
-    m_schedule.emplace(t, payload);
+    slot_list* slots = lookup(payload);
+    if (slots) {
+        for (size_t id : *slots)
+            if (m_slots[id].time == t)
+                return;
+    } else if constexpr (peq_hashable<T>::value) {
+        slots = &m_index[payload];
+    } else {
+        m_index.emplace_back(payload, slot_list());
+        slots = &m_index.back().second;
+    }
+
+    size_t id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+        m_slots[id] = { t, m_seq++, payload, m_heap.size() };
+    } else {
+        id = m_slots.size();
+        m_slots.push_back({ t, m_seq++, payload, m_heap.size() });
+    }
+
+    slots->push_back(id);
+    m_heap.push_back(id);
+    sift_up(m_heap.size() - 1);
     update();
 }
 
 template <typename T>
 inline void peq<T>::cancel(const T& payload) {
-    if (m_schedule.empty())
+    slot_list* slots = lookup(payload);
+    if (slots == nullptr)
         return;
 
-    mwr::stl_remove(m_schedule, payload);
+    // remove the slots from the heap right away instead of waiting for their
+    // deadline, so that repeated cancellations cannot pile up
+    for (size_t id : *slots)
+        remove(m_slots[id].pos);
+
+    forget(payload);
     update();
 }
 
 template <typename T>
 inline void peq<T>::wait(T& obj) {
-    auto it = m_schedule.find(sc_time_stamp());
-    while (it == m_schedule.end()) {
+    while (true) {
+        if (!m_heap.empty()) {
+            const slot& next = m_slots[m_heap.front()];
+            if (next.time <= sc_time_stamp())
+                break;
+        }
+
         sc_core::wait(m_event);
-        it = m_schedule.find(sc_time_stamp());
-        update();
+        m_armed = SC_MAX_TIME;
+    }
+
+    size_t id = m_heap.front();
+    obj = m_slots[id].payload;
+
+    slot_list* slots = lookup(obj);
+    if (slots != nullptr) {
+        stl_remove(*slots, id);
+        if (slots->empty())
+            forget(obj);
     }
 
-    obj = it->second;
-    m_schedule.erase(it);
+    remove(0);
     update();
 }
 
@@ -97,6 +97,14 @@ public:
     virtual tlm_response_status write(const range& addr, const void* data,
                                       const tlm_sbi& info);
 
+    // byte-enabled accesses, mask holds one entry per byte in addr
+    virtual tlm_response_status read(const range& addr, void* data,
+                                     const u8* mask, const tlm_sbi& info,
+                                     address_space as);
+    virtual tlm_response_status write(const range& addr, const void* data,
+                                      const u8* mask, const tlm_sbi& info,
+                                      address_space as);
+
     virtual void handle_clock_update(hz_t oldclk, hz_t newclk) override;
 };
 
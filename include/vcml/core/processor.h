@@ -43,9 +43,20 @@ private:
 
     debugging::gdbserver* m_gdb;
 
-    unordered_map<size_t, irq_stats> m_irq_stats;
+    vector<irq_stats> m_irq_stats;
     unordered_map<u64, property<void>*> m_regprops;
 
+    sc_event m_wakeup;
+    sc_time m_idle_time;
+
+    u64 m_profile_next;
+    size_t m_profile_samples;
+    std::map<vector<u64>, size_t> m_profile;
+    vector<debugging::stackframe> m_profile_trace;
+
+    vector<u64> m_fetch_tags;
+    vector<u8> m_fetch_data;
+
     bool cmd_dump(const vector<string>& args, ostream& os);
     bool cmd_read(const vector<string>& args, ostream& os);
     bool cmd_symbols(const vector<string>& args, ostream& os);
@@ -54,6 +65,7 @@ private:
     bool cmd_v2p(const vector<string>& args, ostream& os);
     bool cmd_stack(const vector<string>& args, ostream& os);
     bool cmd_gdb(const vector<string>& args, ostream& os);
+    bool cmd_profile(const vector<string>& args, ostream& os);
 
     virtual bool read_cpureg_dbg(const debugging::cpureg& reg, void* buf,
                                  size_t len) override;
@@ -61,7 +73,13 @@ private:
                                   size_t len) override;
 
     u64 simulate_cycles(size_t cycles);
+    void simulate_profiled(size_t cycles);
+    u64 profile_cycles() const;
+    void sample_profile();
+    bool can_skip_idle() const;
+    void skip_idle();
     void processor_thread();
+    const u8* fetch_line(u64 addr, size_t size);
     bool processor_thread_sync();
     bool processor_thread_async();
 
@@ -77,6 +95,18 @@ public:
     property<bool> async;
     property<unsigned int> async_rate;
 
+    property<bool> idle_skip;
+    property<sc_time> idle_limit;
+
+    property<string> profile;
+    property<u64> profile_interval;
+    property<sc_time> profile_period;
+    property<size_t> profile_depth;
+
+    property<bool> fetch_cache;
+    property<u64> fetch_cache_line;
+    property<size_t> fetch_cache_lines;
+
     gpio_target_array irq;
 
     tlm_initiator_socket insn;
@@ -92,23 +122,40 @@ public:
     virtual void session_suspend() override;
     virtual void session_resume() override;
 
+    virtual void serialize(checkpoint& ckpt) override;
+
     virtual u64 cycle_count() const = 0;
 
     double get_run_time() const { return m_run_time; }
     double get_cps() const { return cycle_count() / m_run_time; }
 
+    // simulated time skipped while the processor reported being idle
+    const sc_time& get_idle_time() const { return m_idle_time; }
+
+    // to be overloaded by models that can tell they are waiting for an
+    // interrupt, e.g. sleeping in wfi or spinning in a known polling loop
+    virtual bool is_idle() const { return false; }
+
+    size_t profile_samples() const { return m_profile_samples; }
+    void write_profile(const string& file) const;
+
     virtual void reset() override;
 
+    // drops cached instruction lines, to be called by models that execute
+    // instruction cache maintenance operations or modify code themselves
+    void flush_fetch_cache();
+    void flush_fetch_cache(u64 start, u64 end);
+
     bool get_irq_stats(size_t irq, irq_stats& stats) const;
 
     template <typename T>
     inline tlm_response_status fetch(u64 addr, T& data);
 
     template <typename T>
-    inline tlm_response_status read(u64 addr, T& data);
+    inline tlm_response_status read(u64 addr, T& val);
 
     template <typename T>
-    inline tlm_response_status write(u64 addr, const T& data);
+    inline tlm_response_status write(u64 addr, const T& val);
 
 protected:
     void log_bus_error(const tlm_initiator_socket& socket, vcml_access rwx,
@@ -117,12 +164,16 @@ protected:
     virtual void gpio_notify(const gpio_target_socket& socket, bool state,
                              gpio_vector vector) override;
 
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+
     virtual void interrupt(size_t irq, bool set, gpio_vector vector);
     virtual void interrupt(size_t irq, bool set);
 
     virtual void simulate(size_t cycles) = 0;
     virtual void update_local_time(sc_time& time, sc_process_b* proc) override;
     virtual void end_of_elaboration() override;
+    virtual void end_of_simulation() override;
 
     virtual void fetch_cpuregs();
     virtual void flush_cpuregs();
@@ -148,6 +199,14 @@ protected:
 
 template <typename T>
 inline tlm_response_status processor::fetch(u64 addr, T& data) {
+    if (!m_fetch_tags.empty()) {
+        const u8* ptr = fetch_line(addr, sizeof(T));
+        if (ptr != nullptr) {
+            memcpy(&data, ptr, sizeof(T));
+            return TLM_OK_RESPONSE;
+        }
+    }
+
     tlm_response_status rs = insn.readw(addr, data);
     if (failed(rs))
         log_bus_error(insn, VCML_ACCESS_READ, rs, addr, sizeof(T));
@@ -155,18 +214,20 @@ inline tlm_response_status processor::fetch(u64 addr, T& data) {
 }
 
 template <typename T>
-inline tlm_response_status processor::read(u64 addr, T& data) {
-    tlm_response_status rs = data.readw(addr, data);
+inline tlm_response_status processor::read(u64 addr, T& val) {
+    tlm_response_status rs = data.readw(addr, val);
     if (failed(rs))
         log_bus_error(data, VCML_ACCESS_READ, rs, addr, sizeof(T));
     return rs;
 }
 
 template <typename T>
-inline tlm_response_status processor::write(u64 addr, const T& data) {
-    tlm_response_status rs = data.writew(addr, data);
+inline tlm_response_status processor::write(u64 addr, const T& val) {
+    tlm_response_status rs = data.writew(addr, val);
     if (failed(rs))
         log_bus_error(data, VCML_ACCESS_WRITE, rs, addr, sizeof(T));
+    else if (!m_fetch_tags.empty())
+        flush_fetch_cache(addr, addr + sizeof(T) - 1);
     return rs;
 }
 
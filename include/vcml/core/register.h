@@ -14,6 +14,7 @@
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/range.h"
+#include "vcml/core/checkpoint.h"
 
 #include "vcml/logging/logger.h"
 #include "vcml/properties/property.h"
@@ -38,7 +39,8 @@ private:
     u64 m_privilege;
     peripheral* m_host;
 
-    void do_receive(tlm_generic_payload& tx, const tlm_sbi& info);
+protected:
+    virtual void do_receive(tlm_generic_payload& tx, const tlm_sbi& info);
 
 public:
     const address_space as;
@@ -89,6 +91,9 @@ public:
     peripheral* get_host() const { return m_host; }
     int current_cpu() const;
 
+    // simulation time of the initiator including its quantum offset
+    sc_time local_time_stamp() const;
+
     reg_base(address_space as, const string& nm, u64 addr, u64 size, u64 n);
     virtual ~reg_base();
 
@@ -100,6 +105,16 @@ public:
 
     virtual void do_read(const range& addr, void* ptr) = 0;
     virtual void do_write(const range& addr, const void* ptr) = 0;
+
+    // byte-enabled accesses, mask holds one entry per byte in addr
+    virtual void do_read_masked(const range& addr, void* ptr,
+                                const u8* mask);
+    virtual void do_write_masked(const range& addr, const void* ptr,
+                                 const u8* mask);
+
+    // saves or restores all banks other than bank 0, which is already held
+    // by the property value
+    virtual void serialize_banks(checkpoint& ckpt);
 };
 
 inline bool reg_base::is_read_only() const {
@@ -119,8 +134,16 @@ public:
     typedef function<DATA(size_t)> readfn_tagged;
     typedef function<void(DATA, size_t)> writefn_tagged;
 
+    // timed read callbacks receive the local time stamp of the initiator,
+    // which allows models to compute time dependent values (e.g. counters)
+    // without sync_on_read forcing the initiator out of its quantum
+    typedef function<DATA(const sc_time&)> readfn_timed;
+    typedef function<DATA(size_t, const sc_time&)> readfn_tagged_timed;
+
     void on_read(const readfn& rd);
     void on_read(const readfn_tagged& rd);
+    void on_read(const readfn_timed& rd);
+    void on_read(const readfn_tagged_timed& rd);
 
     template <typename HOST>
     void on_read(DATA (HOST::*rd)(void), HOST* host = nullptr);
@@ -128,6 +151,13 @@ public:
     template <typename HOST>
     void on_read(DATA (HOST::*rd)(size_t), HOST* host = nullptr);
 
+    template <typename HOST>
+    void on_read(DATA (HOST::*rd)(const sc_time&), HOST* host = nullptr);
+
+    template <typename HOST>
+    void on_read(DATA (HOST::*rd)(size_t, const sc_time&),
+                 HOST* host = nullptr);
+
     void on_write(const writefn& wr);
     void on_write(const writefn_tagged& wr);
 
@@ -167,6 +197,10 @@ public:
 
     virtual void do_read(const range& addr, void* ptr) override;
     virtual void do_write(const range& addr, const void* ptr) override;
+    virtual void do_write_masked(const range& addr, const void* ptr,
+                                 const u8* mask) override;
+
+    virtual void serialize_banks(checkpoint& ckpt) override;
 
     operator DATA() const;
     operator DATA&();
@@ -233,23 +267,42 @@ private:
     writefn m_write;
     readfn_tagged m_read_tagged;
     writefn_tagged m_write_tagged;
+    readfn_timed m_read_timed;
+    readfn_tagged_timed m_read_tagged_timed;
 
+    bool has_read_callback() const;
     void init_bank(int bank);
 };
+
+template <typename DATA, size_t N>
+bool reg<DATA, N>::has_read_callback() const {
+    return m_read || m_read_tagged || m_read_timed || m_read_tagged_timed;
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_read(const readfn& rd) {
-    VCML_ERROR_ON(m_read, "read callback already defined");
-    VCML_ERROR_ON(m_read_tagged, "tagged read callback already defined");
+    VCML_ERROR_ON(has_read_callback(), "read callback already defined");
     m_read = rd;
 }
 
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_read(const readfn_tagged& rd) {
-    VCML_ERROR_ON(m_read, "read callback already defined");
-    VCML_ERROR_ON(m_read_tagged, "tagged read callback already defined");
+    VCML_ERROR_ON(has_read_callback(), "read callback already defined");
     m_read_tagged = rd;
 }
 
+template <typename DATA, size_t N>
+void reg<DATA, N>::on_read(const readfn_timed& rd) {
+    VCML_ERROR_ON(has_read_callback(), "read callback already defined");
+    m_read_timed = rd;
+}
+
+template <typename DATA, size_t N>
+void reg<DATA, N>::on_read(const readfn_tagged_timed& rd) {
+    VCML_ERROR_ON(has_read_callback(), "read callback already defined");
+    m_read_tagged_timed = rd;
+}
+
 template <typename DATA, size_t N>
 template <typename HOST>
 void reg<DATA, N>::on_read(DATA (HOST::*rd)(void), HOST* host) {
@@ -270,6 +323,28 @@ void reg<DATA, N>::on_read(DATA (HOST::*rd)(size_t), HOST* host) {
     on_read(fn);
 }
 
+template <typename DATA, size_t N>
+template <typename HOST>
+void reg<DATA, N>::on_read(DATA (HOST::*rd)(const sc_time&), HOST* host) {
+    if (host == nullptr)
+        host = dynamic_cast<HOST*>(get_host());
+    VCML_ERROR_ON(!host, "timed read callback has no host");
+    readfn_timed fn = std::bind(rd, host, std::placeholders::_1);
+    on_read(fn);
+}
+
+template <typename DATA, size_t N>
+template <typename HOST>
+void reg<DATA, N>::on_read(DATA (HOST::*rd)(size_t, const sc_time&),
+                           HOST* host) {
+    if (host == nullptr)
+        host = dynamic_cast<HOST*>(get_host());
+    VCML_ERROR_ON(!host, "tagged timed read callback has no host");
+    readfn_tagged_timed fn = std::bind(rd, host, std::placeholders::_1,
+                                       std::placeholders::_2);
+    on_read(fn);
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::on_write(const writefn& wr) {
     VCML_ERROR_ON(m_write, "write callback already defined");
@@ -374,7 +449,9 @@ reg<DATA, N>::reg(address_space a, const string& nm, u64 addr, DATA d):
     m_read(),
     m_write(),
     m_read_tagged(),
-    m_write_tagged() {
+    m_write_tagged(),
+    m_read_timed(),
+    m_read_tagged_timed() {
     for (size_t i = 0; i < N; i++)
         m_init[i] = property<DATA, N>::get(i);
 }
@@ -416,6 +493,10 @@ void reg<DATA, N>::do_read(const range& txaddr, void* ptr) {
 
         if (m_read_tagged)
             val = m_read_tagged(N > 1 ? idx : tag);
+        else if (m_read_tagged_timed)
+            val = m_read_tagged_timed(N > 1 ? idx : tag, local_time_stamp());
+        else if (m_read_timed)
+            val = m_read_timed(local_time_stamp());
         else if (m_read)
             val = m_read();
         else
@@ -459,6 +540,44 @@ void reg<DATA, N>::do_write(const range& txaddr, const void* data) {
     }
 }
 
+template <typename DATA, size_t N>
+void reg<DATA, N>::do_write_masked(const range& txaddr, const void* data,
+                                   const u8* mask) {
+    range addr(txaddr);
+    const unsigned char* src = (const unsigned char*)data;
+
+    while (addr.start <= addr.end) {
+        u64 idx = addr.start / sizeof(DATA);
+        u64 off = addr.start % sizeof(DATA);
+        u64 size = min(addr.length(), (u64)sizeof(DATA) - off);
+
+        // merge enabled bytes into the current value, invoke callbacks once
+        DATA val = current_bank(idx);
+        unsigned char* ptr = (unsigned char*)&val + off;
+
+        bool enabled = false;
+        for (u64 i = 0; i < size; i++) {
+            if (mask[i]) {
+                ptr[i] = src[i];
+                enabled = true;
+            }
+        }
+
+        if (enabled) {
+            if (m_write_tagged)
+                m_write_tagged(val, N > 1 ? idx : tag);
+            else if (m_write)
+                m_write(val);
+            else
+                current_bank(idx) = val;
+        }
+
+        addr.start += size;
+        src += size;
+        mask += size;
+    }
+}
+
 template <typename DATA, size_t N>
 reg<DATA, N>::operator DATA() const {
     return current_bank();
@@ -666,6 +785,40 @@ inline void reg<DATA, N>::set_bit(bool set) {
         vcml::set_bit<BIT>(current_bank(i), set);
 }
 
+template <typename DATA, size_t N>
+void reg<DATA, N>::serialize_banks(checkpoint& ckpt) {
+    if (!m_banked)
+        return;
+
+    // the list of banks comes first, so that restoring knows which banks to
+    // create, each bank is then stored as <reg>@<bank>
+    const string base = property<DATA, N>::basename();
+    string list;
+    if (ckpt.is_saving()) {
+        for (const auto& it : m_banks)
+            list += (list.empty() ? "" : " ") + to_string<int>(it.first);
+    }
+
+    if (!ckpt.value(base + "@banks", list) || list.empty())
+        return;
+
+    for (const string& id : split(list)) {
+        int bk = from_string<int>(id);
+        string val;
+        if (ckpt.is_saving()) {
+            for (size_t i = 0; i < N; i++)
+                val += (i ? " " : "") + to_string<DATA>(bank(bk, i));
+        }
+
+        if (!ckpt.value(base + "@" + id, val) || !ckpt.is_restoring())
+            continue;
+
+        vector<string> vals = split(val);
+        for (size_t i = 0; i < min(N, vals.size()); i++)
+            bank(bk, i) = from_string<DATA>(trim(vals[i]));
+    }
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::init_bank(int bank) {
     VCML_ERROR_ON(!m_banked, "cannot create banks in register %s", name());
@@ -0,0 +1,433 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_REGMAP_H
+#define VCML_REGMAP_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/range.h"
+#include "vcml/core/register.h"
+#include "vcml/core/peripheral.h"
+
+#include "vcml/properties/property.h"
+#include "vcml/protocols/tlm.h"
+
+namespace vcml {
+
+// Compile-time description of a single register within a regmap. READ must
+// be nullptr or a member function DATA (HOST::*)(), WRITE must be nullptr or
+// a member function void (HOST::*)(DATA). Registers without handlers read
+// and write their storage directly.
+template <u64 ADDR, typename DATA, vcml_access ACCESS = VCML_ACCESS_READ_WRITE,
+          DATA INIT = DATA(), auto READ = nullptr, auto WRITE = nullptr>
+struct regdef {
+    static_assert(std::is_integral_v<DATA>, "register data must be integral");
+
+    typedef DATA data_type;
+
+    static constexpr u64 address = ADDR;
+    static constexpr u64 size = sizeof(DATA);
+    static constexpr u64 end = ADDR + sizeof(DATA) - 1;
+    static constexpr vcml_access access = ACCESS;
+    static constexpr DATA init = INIT;
+
+    static constexpr auto read_handler = READ;
+    static constexpr auto write_handler = WRITE;
+
+    static constexpr bool has_read_handler =
+        !std::is_null_pointer_v<decltype(READ)>;
+    static constexpr bool has_write_handler =
+        !std::is_null_pointer_v<decltype(WRITE)>;
+
+    static constexpr bool overlaps(const range& r) {
+        return r.start <= end && r.end >= address;
+    }
+};
+
+// A regmap groups a set of regdefs into a single register window of its
+// host peripheral. Layout, permissions and handlers are resolved at compile
+// time, so an access costs one virtual call into the map, after which the
+// decoder calls the host handlers directly. The storage of each register is
+// still exposed as a property of the host, using the names passed during
+// construction.
+template <typename HOST, typename... REGS>
+class regmap : public reg_base
+{
+public:
+    static constexpr size_t count = sizeof...(REGS);
+    static constexpr u64 span = std::max({ (REGS::end + 1)... });
+
+    typedef array<const char*, sizeof...(REGS)> names_type;
+
+    template <typename REG>
+    static constexpr size_t index_of();
+
+private:
+    static_assert(sizeof...(REGS) > 0, "regmap needs at least one register");
+
+    template <typename REG>
+    class cell : public property<typename REG::data_type>
+    {
+    public:
+        cell(const char* nm):
+            property<typename REG::data_type>(nm, REG::init) {}
+    };
+
+    static constexpr bool is_disjoint();
+
+    HOST* m_owner;
+    std::tuple<cell<REGS>...> m_cells;
+    std::tuple<typename REGS::data_type...> m_init;
+
+    template <size_t... I>
+    regmap(address_space as, const string& nm, u64 base, const names_type& n,
+           std::index_sequence<I...>);
+
+    template <typename REG>
+    typename REG::data_type read_reg();
+    template <typename REG>
+    void write_reg(typename REG::data_type val);
+
+    template <typename REG>
+    void read_one(const range& addr, u8* dest);
+    template <typename REG>
+    void read_one(const range& addr, u8* dest, const u8* mask);
+    template <typename REG>
+    void write_one(const range& addr, const u8* src);
+    template <typename REG>
+    void write_one(const range& addr, const u8* src, const u8* mask);
+
+    template <size_t... I>
+    void reset_all(std::index_sequence<I...>);
+
+protected:
+    virtual void do_receive(tlm_generic_payload& tx,
+                            const tlm_sbi& info) override;
+
+public:
+    regmap(const string& nm, u64 base, const names_type& names);
+    regmap(address_space as, const string& nm, u64 base,
+           const names_type& names);
+    virtual ~regmap() = default;
+    VCML_KIND(regmap);
+
+    template <typename REG>
+    const typename REG::data_type& get() const;
+    template <typename REG>
+    typename REG::data_type& get();
+
+    template <typename REG>
+    void set(typename REG::data_type val);
+
+    template <typename REG>
+    const property<typename REG::data_type>& prop() const;
+
+    virtual void reset() override;
+
+    virtual void do_read(const range& addr, void* ptr) override;
+    virtual void do_write(const range& addr, const void* ptr) override;
+    virtual void do_read_masked(const range& addr, void* ptr,
+                                const u8* mask) override;
+    virtual void do_write_masked(const range& addr, const void* ptr,
+                                 const u8* mask) override;
+};
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+constexpr size_t regmap<HOST, REGS...>::index_of() {
+    constexpr bool match[] = { std::is_same_v<REG, REGS>... };
+    for (size_t i = 0; i < sizeof...(REGS); i++)
+        if (match[i])
+            return i;
+    return sizeof...(REGS);
+}
+
+template <typename HOST, typename... REGS>
+constexpr bool regmap<HOST, REGS...>::is_disjoint() {
+    constexpr u64 lo[] = { REGS::address... };
+    constexpr u64 hi[] = { REGS::end... };
+    for (size_t i = 0; i < sizeof...(REGS); i++) {
+        for (size_t j = i + 1; j < sizeof...(REGS); j++)
+            if (lo[i] <= hi[j] && lo[j] <= hi[i])
+                return false;
+    }
+
+    return true;
+}
+
+template <typename HOST, typename... REGS>
+template <size_t... I>
+regmap<HOST, REGS...>::regmap(address_space a, const string& nm, u64 base,
+                              const names_type& names,
+                              std::index_sequence<I...>):
+    reg_base(a, nm, base, span, 1),
+    m_owner(dynamic_cast<HOST*>(get_host())),
+    m_cells(names[I]...),
+    m_init(std::get<I>(m_cells).get()...) {
+    static_assert(is_disjoint(), "regmap registers must not overlap");
+    VCML_ERROR_ON(!m_owner, "regmap %s has invalid host", name());
+}
+
+template <typename HOST, typename... REGS>
+regmap<HOST, REGS...>::regmap(const string& nm, u64 base,
+                              const names_type& names):
+    regmap(VCML_AS_DEFAULT, nm, base, names) {
+}
+
+template <typename HOST, typename... REGS>
+regmap<HOST, REGS...>::regmap(address_space a, const string& nm, u64 base,
+                              const names_type& names):
+    regmap(a, nm, base, names, std::index_sequence_for<REGS...>()) {
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline const typename REG::data_type& regmap<HOST, REGS...>::get() const {
+    constexpr size_t idx = index_of<REG>();
+    static_assert(idx < count, "register not part of regmap");
+    return std::get<idx>(m_cells).get();
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline typename REG::data_type& regmap<HOST, REGS...>::get() {
+    constexpr size_t idx = index_of<REG>();
+    static_assert(idx < count, "register not part of regmap");
+    return std::get<idx>(m_cells).get();
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::set(typename REG::data_type val) {
+    get<REG>() = val;
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline const property<typename REG::data_type>& regmap<HOST, REGS...>::prop()
+    const {
+    constexpr size_t idx = index_of<REG>();
+    static_assert(idx < count, "register not part of regmap");
+    return std::get<idx>(m_cells);
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline typename REG::data_type regmap<HOST, REGS...>::read_reg() {
+    if constexpr (REG::has_read_handler) {
+        static_assert(std::is_invocable_r_v<typename REG::data_type,
+                                            decltype(REG::read_handler),
+                                            HOST*>,
+                      "read handler must be DATA (HOST::*)()");
+        typename REG::data_type val = (m_owner->*REG::read_handler)();
+        if (is_writeback())
+            get<REG>() = val;
+        return val;
+    } else {
+        return get<REG>();
+    }
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::write_reg(typename REG::data_type val) {
+    if constexpr (REG::has_write_handler) {
+        static_assert(std::is_invocable_v<decltype(REG::write_handler), HOST*,
+                                          typename REG::data_type>,
+                      "write handler must be void (HOST::*)(DATA)");
+        (m_owner->*REG::write_handler)(val);
+    } else {
+        get<REG>() = val;
+    }
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::read_one(const range& addr, u8* dest) {
+    if (!REG::overlaps(addr))
+        return;
+
+    u64 lo = max(addr.start, REG::address);
+    u64 hi = min(addr.end, REG::end);
+    typename REG::data_type val = read_reg<REG>();
+    memcpy(dest + lo - addr.start, (u8*)&val + lo - REG::address,
+           hi - lo + 1);
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::read_one(const range& addr, u8* dest,
+                                            const u8* mask) {
+    if (!REG::overlaps(addr))
+        return;
+
+    u64 lo = max(addr.start, REG::address);
+    u64 hi = min(addr.end, REG::end);
+
+    bool enabled = false;
+    for (u64 i = lo - addr.start; i <= hi - addr.start && !enabled; i++)
+        enabled = mask[i] != 0;
+
+    if (!enabled)
+        return;
+
+    typename REG::data_type val = read_reg<REG>();
+    const u8* src = (const u8*)&val + lo - REG::address;
+    for (u64 i = 0; i <= hi - lo; i++) {
+        if (mask[lo - addr.start + i])
+            dest[lo - addr.start + i] = src[i];
+    }
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::write_one(const range& addr,
+                                             const u8* src) {
+    if (!REG::overlaps(addr))
+        return;
+
+    u64 lo = max(addr.start, REG::address);
+    u64 hi = min(addr.end, REG::end);
+    typename REG::data_type val = get<REG>();
+    memcpy((u8*)&val + lo - REG::address, src + lo - addr.start,
+           hi - lo + 1);
+    write_reg<REG>(val);
+}
+
+template <typename HOST, typename... REGS>
+template <typename REG>
+inline void regmap<HOST, REGS...>::write_one(const range& addr, const u8* src,
+                                             const u8* mask) {
+    if (!REG::overlaps(addr))
+        return;
+
+    u64 lo = max(addr.start, REG::address);
+    u64 hi = min(addr.end, REG::end);
+    typename REG::data_type val = get<REG>();
+    u8* dest = (u8*)&val + lo - REG::address;
+
+    bool enabled = false;
+    for (u64 i = 0; i <= hi - lo; i++) {
+        if (mask[lo - addr.start + i]) {
+            dest[i] = src[lo - addr.start + i];
+            enabled = true;
+        }
+    }
+
+    if (enabled)
+        write_reg<REG>(val);
+}
+
+template <typename HOST, typename... REGS>
+template <size_t... I>
+void regmap<HOST, REGS...>::reset_all(std::index_sequence<I...>) {
+    ((std::get<I>(m_cells).get() = std::get<I>(m_init)), ...);
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::do_receive(tlm_generic_payload& tx,
+                                       const tlm_sbi& info) {
+    const range addr(tx);
+    const bool rd = tx.is_read();
+
+    if (!(REGS::overlaps(addr) || ...)) {
+        tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+
+    if (!info.is_debug) {
+        bool allowed = rd ? is_readable() : is_writeable();
+        if (rd) {
+            allowed &= ((!REGS::overlaps(addr) ||
+                         is_read_allowed(REGS::access)) &&
+                        ...);
+        } else {
+            allowed &= ((!REGS::overlaps(addr) ||
+                         is_write_allowed(REGS::access)) &&
+                        ...);
+        }
+
+        if (get_privilege() > info.privilege)
+            allowed = false;
+        if (is_secure() && !info.is_secure)
+            allowed = false;
+
+        if (!allowed) {
+            tx.set_response_status(TLM_COMMAND_ERROR_RESPONSE);
+            return;
+        }
+    }
+
+    unsigned char* ptr = tx.get_data_ptr();
+    unsigned char* mask = tx.get_byte_enable_ptr();
+    const bool swap = !m_owner->is_host_endian();
+    if (swap) {
+        memswap(ptr, tx.get_data_length());
+        if (mask)
+            memswap(mask, tx.get_data_length());
+    }
+
+    if (rd) {
+        if (mask)
+            regmap::do_read_masked(addr, ptr, mask);
+        else
+            regmap::do_read(addr, ptr);
+    } else if (tx.is_write()) {
+        if (mask)
+            regmap::do_write_masked(addr, ptr, mask);
+        else
+            regmap::do_write(addr, ptr);
+    }
+
+    if (swap) {
+        memswap(ptr, tx.get_data_length());
+        if (mask)
+            memswap(mask, tx.get_data_length());
+    }
+
+    tx.set_response_status(TLM_OK_RESPONSE);
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::reset() {
+    reset_all(std::index_sequence_for<REGS...>());
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::do_read(const range& addr, void* ptr) {
+    u8* dest = (u8*)ptr;
+    memset(dest, 0, addr.length()); // gaps between registers read as zero
+    (read_one<REGS>(addr, dest), ...);
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::do_write(const range& addr, const void* ptr) {
+    const u8* src = (const u8*)ptr;
+    (write_one<REGS>(addr, src), ...);
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::do_read_masked(const range& addr, void* ptr,
+                                           const u8* mask) {
+    u8* dest = (u8*)ptr;
+    (read_one<REGS>(addr, dest, mask), ...);
+}
+
+template <typename HOST, typename... REGS>
+void regmap<HOST, REGS...>::do_write_masked(const range& addr,
+                                            const void* ptr,
+                                            const u8* mask) {
+    const u8* src = (const u8*)ptr;
+    (write_one<REGS>(addr, src, mask), ...);
+}
+
+} // namespace vcml
+
+#endif
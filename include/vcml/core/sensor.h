@@ -0,0 +1,62 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_SENSOR_H
+#define VCML_SENSOR_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+// A sensor reading that is evaluated lazily from simulated time, so models
+// do not need to poll for it. The value is either static or ramps linearly
+// towards a target. Owners register the thresholds they care about using
+// watch and make their alarm logic sensitive to event(), which is notified
+// whenever the value jumps or reaches the closest watched threshold. Each
+// threshold crossing is reported once, owners re-arm by calling watch again.
+class sensor : public sc_object
+{
+private:
+    double m_value;
+    double m_target;
+    double m_rate;
+    sc_time m_start;
+
+    vector<double> m_thresholds;
+    sc_event m_event;
+
+    void rearm();
+
+public:
+    const sc_event& event() const { return m_event; }
+
+    double value() const { return value_at(sc_time_stamp()); }
+    double value_at(const sc_time& t) const;
+
+    double target() const { return m_target; }
+    bool is_static() const;
+
+    sensor(const char* nm, double init = 0.0);
+    virtual ~sensor() = default;
+    VCML_KIND(sensor);
+
+    void set(double val);
+    void ramp(double target, double rate_per_sec);
+
+    sc_time time_to(double threshold) const;
+
+    void watch(const vector<double>& thresholds);
+    void unwatch();
+};
+
+} // namespace vcml
+
+#endif
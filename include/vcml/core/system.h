@@ -22,7 +22,20 @@ namespace vcml {
 class system : public module
 {
 private:
+    size_t m_fork_id;
+    atomic<size_t> m_fork_requested;
+    sc_event m_fork_ev;
+    int m_fork_status;
+
     void timeout();
+    void checkpoint_thread();
+    void fork_thread();
+
+    bool cmd_checkpoint(const vector<string>& args, ostream& os);
+    bool cmd_restore(const vector<string>& args, ostream& os);
+    bool cmd_fork(const vector<string>& args, ostream& os);
+
+    void exit_fork_child(int status);
 
 public:
     property<string> name;
@@ -37,6 +50,13 @@ public:
     property<sc_time> quantum;
     property<sc_time> duration;
 
+    property<string> checkpoint_dir;
+    property<sc_time> checkpoint_at;
+    property<string> restore;
+
+    property<sc_time> fork_at;
+    property<size_t> fork_count;
+
     system() = delete;
     system(const system&) = delete;
     explicit system(const sc_module_name& name);
@@ -44,6 +64,23 @@ public:
     VCML_KIND(system);
 
     virtual int run();
+
+    // system properties configure the run, they are not part of its state
+    virtual void serialize(checkpoint& ckpt) override {}
+
+    void save_checkpoint(const string& dir);
+    void restore_checkpoint(const string& dir);
+
+    // id of this process after forking, zero in the original process
+    size_t fork_id() const { return m_fork_id; }
+    bool is_fork_child() const { return m_fork_id > 0; }
+
+    void request_fork(size_t count);
+    void fork_simulation(size_t count);
+
+protected:
+    virtual void start_of_simulation() override;
+    virtual void end_of_simulation() override;
 };
 
 } // namespace vcml
@@ -354,12 +354,45 @@ private:
     function<void(async_timer&)> m_cb;
 };
 
+// sc_event that may be notified from any thread, e.g. by host input or
+// network backends; notifications are delivered in the next update phase
+// and coalesced until then
+class async_event
+{
+private:
+    struct state {
+        sc_event* event;
+        atomic<bool> pending;
+    };
+
+    sc_event m_event;
+    shared_ptr<state> m_state;
+
+public:
+    const sc_event& event() const { return m_event; }
+
+    async_event(const char* nm);
+    ~async_event();
+
+    async_event() = delete;
+    async_event(const async_event&) = delete;
+
+    void notify();
+};
+
 void sc_async(function<void(void)> job);
 void sc_progress(const sc_time& delta);
 void sc_sync(function<void(void)> job);
 
 bool sc_is_async();
 
+// used to quiesce async workers, e.g. before forking the simulation: while
+// held, new sc_async jobs are parked until sc_async_release is called
+void sc_async_hold();
+void sc_async_release();
+bool sc_async_idle();
+void sc_async_respawn();
+
 sc_time async_time_stamp();
 sc_time async_time_offset();
 
@@ -27,6 +27,7 @@ private:
     string m_announce;
     string m_stop_reason;
     sc_time m_duration;
+    bool m_detached;
 
     unordered_map<u64, const breakpoint*> m_breakpoints;
 
@@ -70,6 +71,9 @@ public:
     void start();
     void cleanup();
 
+    // stops taking requests, the session keeps simulating to completion
+    void detach();
+
     virtual void handle_connect(const char* peer) override;
     virtual void handle_disconnect() override;
 
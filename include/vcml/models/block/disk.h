@@ -48,6 +48,7 @@ public:
     } stats;
 
     property<string> image;
+    property<string> fork_image;
     property<string> serial;
     property<bool> readonly;
 
@@ -58,6 +59,9 @@ public:
     virtual ~disk();
     VCML_KIND(block::drive);
 
+    virtual void fork_prepare() override;
+    virtual void fork_child(size_t id) override;
+
     size_t capacity();
     size_t pos();
     size_t remaining();
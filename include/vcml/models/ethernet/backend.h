@@ -39,8 +39,14 @@ public:
     backend(const backend&) = delete;
     backend(backend&&) = default;
 
+    // backends that can forward partial checksums to the host return true,
+    // all others receive frames with their checksums completed
+    virtual bool supports_offload() const { return false; }
+
     virtual void send_to_host(const eth_frame& frame) = 0;
     virtual void send_to_guest(eth_frame frame);
+    virtual void send_to_guest(const u8* data, size_t len,
+                               const eth_offload& offload);
 
     static backend* create(bridge* br, const string& type);
 };
@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/mpsc.h"
 
 #include "vcml/properties/property.h"
 #include "vcml/protocols/eth.h"
@@ -31,15 +32,19 @@ private:
     size_t m_next_id;
     unordered_map<size_t, backend*> m_dynamic_backends;
     vector<backend*> m_backends;
+    vector<string> m_fork_types;
 
-    mutable mutex m_mtx;
-    queue<eth_frame> m_rx;
-    sc_event m_ev;
+    // frames from the host travel through a lock-free ring whose buffers
+    // are recycled, the simulation drains it in bursts of rx_budget frames
+    mpsc_queue<eth_frame, 256> m_rx;
+    vector<eth_frame> m_rx_batch;
+    async_event m_rx_ev;
 
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
     bool cmd_list_backends(const vector<string>& args, ostream& os);
 
+    virtual bool eth_rx_offload() const override { return true; }
     virtual void eth_receive(const eth_frame& frame) override;
 
     void eth_transmit();
@@ -48,6 +53,8 @@ private:
 
 public:
     property<string> backends;
+    property<string> fork_backends;
+    property<size_t> rx_budget;
 
     eth_initiator_socket eth_tx;
     eth_target_socket eth_rx;
@@ -56,8 +63,13 @@ public:
     virtual ~bridge();
     VCML_KIND(ethernet::bridge);
 
+    virtual void fork_prepare() override;
+    virtual void fork_child(size_t id) override;
+
     void send_to_host(const eth_frame& frame);
     void send_to_guest(eth_frame frame);
+    void send_to_guest(const u8* data, size_t len,
+                       const eth_offload& offload = eth_offload());
 
     void attach(backend* b);
     void detach(backend* b);
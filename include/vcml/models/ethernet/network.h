@@ -30,6 +30,7 @@ protected:
         return eth_tx[eth_rx.index_of(rx)];
     }
 
+    bool eth_rx_offload() const override { return true; }
     void eth_receive(const eth_target_socket&, const eth_frame&) override;
 
 public:
@@ -59,6 +59,7 @@ public:
     virtual ~memory();
     VCML_KIND(memory);
     virtual void reset() override;
+    virtual void serialize(checkpoint& ckpt) override;
 
     virtual tlm_response_status read(const range& addr, void* data,
                                      const tlm_sbi& info) override;
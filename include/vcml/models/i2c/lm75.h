@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/sensor.h"
 
 #include "vcml/protocols/gpio.h"
 #include "vcml/protocols/i2c.h"
@@ -28,12 +29,14 @@ private:
     u8 m_buf[2];
     size_t m_len;
     bool m_evt;
+    sensor m_sensor;
 
     bool cmd_set_temp(const vector<string>& args, ostream& os);
+    bool cmd_ramp_temp(const vector<string>& args, ostream& os);
     bool cmd_set_high(const vector<string>& args, ostream& os);
     bool cmd_set_hyst(const vector<string>& args, ostream& os);
 
-    void poll_temp();
+    void sample_temp();
     void irq_update();
     void load_buffer();
     void save_buffer();
@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_META_LAZY_H
+#define VCML_META_LAZY_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/component.h"
+#include "vcml/core/model.h"
+
+#include "vcml/properties/property.h"
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+#include "vcml/protocols/clk.h"
+
+namespace vcml {
+namespace meta {
+
+// Occupies the bus mapping of a wrapped model and only constructs it if it
+// is actually needed. SystemC does not allow creating modules once the
+// elaboration has finished, so with build = "used" the decision is based on
+// a usage file: proxies that get accessed without a model append their name
+// to it and stop the simulation, so that the next run constructs them.
+class lazy : public component
+{
+private:
+    vcml::model* m_model;
+    bool m_reported;
+
+    clk_initiator_socket m_clk;
+    gpio_initiator_socket m_rst;
+    gpio_target_array m_irq;
+
+    bool needs_model();
+    void bind_model(module& mod);
+    void report_usage();
+
+    static std::set<string>& usage_list(const string& file);
+
+protected:
+    virtual void b_transport(tlm_target_socket& origin,
+                             tlm_generic_payload& tx, sc_time& dt) override;
+
+    virtual unsigned int transport_dbg(tlm_target_socket& origin,
+                                       tlm_generic_payload& tx) override;
+
+    virtual bool get_direct_mem_ptr(tlm_target_socket& origin,
+                                    tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override;
+
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+
+    virtual void gpio_transport(const gpio_target_socket& socket,
+                                gpio_payload& tx) override;
+
+    virtual void gpio_notify(const gpio_target_socket& socket, bool state,
+                             gpio_vector vector) override;
+
+public:
+    property<string> wrapped;
+    property<string> build;
+    property<string> usage;
+    property<string> target_port;
+    property<vector<string>> irq_ports;
+
+    tlm_target_socket in;
+    tlm_initiator_socket out;
+    gpio_initiator_array irq;
+
+    bool is_built() const { return m_model != nullptr; }
+    module* wrapped_model() const;
+
+    lazy(const sc_module_name& nm, const string& kind = "");
+    virtual ~lazy();
+    VCML_KIND(meta::lazy);
+
+    virtual void handle_clock_update(hz_t oldclk, hz_t newclk) override;
+};
+
+} // namespace meta
+} // namespace vcml
+
+#endif
@@ -0,0 +1,174 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_META_SHMBRIDGE_H
+#define VCML_META_SHMBRIDGE_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/component.h"
+#include "vcml/core/model.h"
+
+#include "vcml/properties/property.h"
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+
+namespace vcml {
+namespace meta {
+
+struct shm_channel;
+
+// Connects two simulations running in separate processes on the same host
+// through a shared memory channel. The target side is mapped into the bus
+// of one process and forwards its transactions to the initiator side in
+// the other process, which issues them on its own bus. GPIOs are forwarded
+// in both directions and both sides synchronize at quantum boundaries.
+class shmbridge : public component
+{
+public:
+    enum : size_t {
+        SIDE_TARGET = 0,
+        SIDE_INITIATOR = 1,
+    };
+
+    enum : size_t {
+        MESSAGE_DATA_SIZE = 256,
+    };
+
+    enum message_type : u32 {
+        MSG_RESPONSE = 0,
+        MSG_TRANSPORT = 1,
+        MSG_DEBUG = 2,
+        MSG_DMI = 3,
+        MSG_INVALIDATE = 4,
+        MSG_GPIO = 5,
+    };
+
+    enum message_flags : u32 {
+        FLAG_DMI_ALLOWED = bit(0),
+    };
+
+    struct message {
+        u32 type;
+        i32 status;
+        u32 flags;
+        u32 index;
+        u64 id;
+        u64 addr;
+        u64 size;
+        u64 time;
+        u64 vector;
+        u64 offset;
+        u64 extent;
+        u8 data[MESSAGE_DATA_SIZE];
+    };
+
+private:
+    tlm_memory m_shm;
+    shm_channel* m_chan;
+    size_t m_side;
+    u64 m_next_id;
+    unordered_map<u64, message> m_responses;
+
+    vector<message> m_gpio_pending;
+    sc_event m_gpio_ev;
+
+    void sync_thread();
+    void gpio_update();
+
+    static vector<shmbridge*>& bridges();
+
+protected:
+    bool peer_detached() const;
+
+    bool post(message& msg);
+    bool request(message& req, message& rsp);
+    void service();
+
+    virtual void handle_message(message& msg);
+
+    virtual void gpio_notify(const gpio_target_socket& socket, bool state,
+                             gpio_vector vector) override;
+
+    virtual void end_of_simulation() override;
+
+public:
+    property<string> channel;
+    property<sc_time> sync_interval;
+
+    gpio_target_array gpio_in;
+    gpio_initiator_array gpio_out;
+
+    size_t side() const { return m_side; }
+    bool is_connected() const;
+
+    shmbridge(const sc_module_name& nm, size_t side);
+    virtual ~shmbridge();
+    VCML_KIND(meta::shmbridge);
+
+    void detach();
+
+    static void service_all(const shmbridge* except = nullptr);
+};
+
+class shmbridge_target : public shmbridge
+{
+private:
+    std::map<string, tlm_memory> m_mappings;
+
+    u8* map_shared(const string& name, size_t offset, size_t extent);
+
+    void forward(tlm_generic_payload& tx, sc_time& dt, bool debug);
+
+protected:
+    virtual void handle_message(message& msg) override;
+
+    virtual void b_transport(tlm_target_socket& origin,
+                             tlm_generic_payload& tx, sc_time& dt) override;
+
+    virtual unsigned int transport_dbg(tlm_target_socket& origin,
+                                       tlm_generic_payload& tx) override;
+
+    virtual bool get_direct_mem_ptr(tlm_target_socket& origin,
+                                    tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override;
+
+public:
+    tlm_target_socket in;
+
+    shmbridge_target(const sc_module_name& nm);
+    virtual ~shmbridge_target() = default;
+    VCML_KIND(meta::shmbridge_target);
+};
+
+class shmbridge_initiator : public shmbridge
+{
+private:
+    void handle_transport(message& msg);
+    void handle_dmi(message& msg);
+
+protected:
+    virtual void handle_message(message& msg) override;
+
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+
+public:
+    tlm_initiator_socket out;
+
+    shmbridge_initiator(const sc_module_name& nm);
+    virtual ~shmbridge_initiator() = default;
+    VCML_KIND(meta::shmbridge_initiator);
+};
+
+} // namespace meta
+} // namespace vcml
+
+#endif
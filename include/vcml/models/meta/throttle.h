@@ -30,12 +30,27 @@ private:
     u64 m_start;
     u64 m_extra;
 
+    bool m_deadline;
+    double m_rtf;
+    u64 m_origin;
+    sc_time m_origin_sim;
+
     void update();
+    void update_interval_mode(const sc_time& interval);
+    void update_deadline_mode();
 
 public:
     property<sc_time> update_interval;
     property<double> rtf;
 
+    // "deadline" sleeps until absolute host deadlines derived from the
+    // simulation time, "interval" uses the old relative usleep approach
+    property<string> mode;
+
+    // fraction of the real-time lag that is forgiven per update when the
+    // simulation falls behind, 0 catches up fully, 1 never catches up
+    property<double> gain;
+
     throttle(const sc_module_name& nm);
     virtual ~throttle() = default;
     VCML_KIND(throttle);
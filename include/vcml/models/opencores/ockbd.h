@@ -36,6 +36,8 @@ private:
     ui::keyboard m_keyboard;
     ui::console m_console;
 
+    async_event m_input_ev;
+
     void update();
     void key_event(u32 key, u32 down);
 
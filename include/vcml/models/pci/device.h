@@ -80,6 +80,13 @@ struct cap_msi : capability {
         return msi_pending ? (*msi_pending >> vector) & 1u : false;
     }
 
+    // bitmap of all vectors that are pending and not masked
+    u32 deliverable() const {
+        if (!msi_pending)
+            return 0;
+        return *msi_pending & ~(msi_mask ? (u32)*msi_mask : 0u);
+    }
+
     void set_pending(unsigned int vector, bool set = true);
 
     cap_msi(const string& nm, u16 msi_control);
@@ -102,6 +109,11 @@ struct cap_msix : capability {
     msix_entry* msix_table;
 
     u32* msix_pba;
+    u32* msix_mask;
+
+    // one bit per PBA word that has pending vectors; at most 2048 vectors
+    // fit into the table, i.e. 64 PBA words
+    u64 msix_pending_words;
 
     reg<u16>* msix_control;
     reg<u32>* msix_bir_off;
@@ -111,7 +123,7 @@ struct cap_msix : capability {
 
     bool is_masked(unsigned int vector) const {
         return (*msix_control & PCI_MSIX_ALL_MASKED) ||
-               (msix_table[vector].ctrl & PCI_MSIX_MASKED);
+               ((msix_mask[vector / 32] >> (vector % 32)) & 1);
     }
 
     bool is_pending(unsigned int vector) const {
@@ -241,7 +253,10 @@ private:
     void msi_send(unsigned int vector);
     void msi_process();
 
+    vector<unsigned int> m_msix_batch;
+
     void msix_send(unsigned int vector);
+    void msix_send(const vector<unsigned int>& vectors);
     void msix_process();
 
     void write_bars(u32 val, size_t barno);
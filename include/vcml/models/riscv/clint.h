@@ -29,12 +29,12 @@ private:
     sc_time m_time_reset;
     sc_event m_trigger;
 
-    u64 get_cycles() const;
+    u64 get_cycles(const sc_time& t) const;
 
     u32 read_msip(size_t hart);
     void write_msip(u32 val, size_t hart);
     void write_mtimecmp(u64 val, size_t hart);
-    u64 read_mtime();
+    u64 read_mtime(const sc_time& t);
 
     void update_timer();
 
@@ -42,6 +42,7 @@ private:
     size_t m_next_id;
     unordered_map<size_t, backend*> m_backends;
     vector<backend*> m_listeners;
+    vector<string> m_fork_types;
     sc_event m_async_ev;
 
     bool cmd_create_backend(const vector<string>& args, ostream& os);
@@ -57,6 +58,7 @@ private:
 
 public:
     property<string> backends;
+    property<string> fork_backends;
     property<string> config;
     property<bool> untimed;
 
@@ -67,6 +69,9 @@ public:
     virtual ~terminal();
     VCML_KIND(serial::terminal);
 
+    virtual void fork_prepare() override;
+    virtual void fork_child(size_t id) override;
+
     void attach(backend* b);
     void detach(backend* b);
     void notify(backend* b);
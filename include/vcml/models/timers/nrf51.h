@@ -38,11 +38,13 @@ private:
     sc_time ticks_to_time(u32 ticks) const;
 
     u32 counter_mask() const;
-    u32 current_count() const;
+    u32 current_count(const sc_time& t) const;
     u32 next_deadline() const;
 
     void update();
 
+    u32 read_compare(size_t idx, const sc_time& t);
+
     void write_start(u32 val);
     void write_stop(u32 val);
     void write_count(u32 val);
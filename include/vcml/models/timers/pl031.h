@@ -29,7 +29,7 @@ private:
     u32 m_offset;
     sc_event m_notify;
 
-    u32 read_dr();
+    u32 read_dr(const sc_time& t);
 
     void write_mr(u32 val);
     void write_lr(u32 val);
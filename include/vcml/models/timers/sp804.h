@@ -49,7 +49,7 @@ public:
         void trigger();
         void schedule(u32 ticks);
 
-        u32 read_value();
+        u32 read_value(const sc_time& t);
         u32 read_ris();
         u32 read_mis();
 
@@ -88,6 +88,8 @@ private:
     queue<input_event> m_events;
     queue<vq_message> m_messages;
 
+    async_event m_input_ev;
+
     void push_key(u16 key, u32 down) {
         m_events.push({ ui::EV_KEY, key, down });
     }
@@ -127,8 +129,6 @@ public:
     const property<bool> keyboard;
     const property<bool> mouse;
 
-    const property<u64> pollrate;
-
     const property<string> keymap;
 
     const property<size_t> xmax;
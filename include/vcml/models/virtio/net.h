@@ -33,6 +33,8 @@ public:
     };
 
     enum features : u64 {
+        VIRTIO_NET_F_CSUM = bit(0),
+        VIRTIO_NET_F_GUEST_CSUM = bit(1),
         VIRTIO_NET_F_MTU = bit(3),
         VIRTIO_NET_F_MAC = bit(5),
         VIRTIO_NET_F_STATUS = bit(16),
@@ -60,6 +62,7 @@ private:
     bool m_nomulti;
     bool m_nouni;
     bool m_nobcast;
+    bool m_guest_csum;
 
     vector<mac_addr> m_unicast;
     vector<mac_addr> m_multicast;
@@ -91,11 +94,13 @@ private:
 
     virtual void eth_link_up() override;
     virtual void eth_link_down() override;
+    virtual bool eth_rx_offload() const override { return true; }
     virtual void eth_receive(const eth_frame& frame) override;
 
 public:
     property<string> mac;
     property<u16> mtu;
+    property<bool> csum_offload;
 
     virtio_target_socket virtio_in;
     eth_initiator_socket eth_tx;
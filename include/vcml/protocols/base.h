@@ -26,10 +26,17 @@
 
 namespace vcml {
 
+template <typename SOCKET>
+class socket_array;
+
 class base_socket
 {
 private:
     sc_object* m_port;
+    size_t m_index;
+
+    template <typename SOCKET>
+    friend class socket_array;
 
 public:
     const address_space as;
@@ -40,6 +47,7 @@ public:
     base_socket() = delete;
     base_socket(sc_object* port, address_space space):
         m_port(port),
+        m_index(SIZE_MAX),
         as(space),
         trace_all(port, "trace", false),
         trace_errors(port, "trace_errors", false) {
@@ -51,6 +59,9 @@ public:
 
     virtual const char* version() const { return VCML_VERSION_STRING; }
 
+    // index within the owning socket_array, SIZE_MAX if not part of one
+    size_t index() const { return m_index; }
+
 protected:
     template <typename PAYLOAD>
     void trace_fw(const PAYLOAD& tx, const sc_time& t = SC_ZERO_TIME) {
@@ -122,6 +133,9 @@ template <typename T>
 struct supports_tracing<T, std::void_t<decltype(std::declval<T>().trace_all)>>
     : std::true_type {};
 
+template <typename T>
+struct supports_indexing : std::is_base_of<base_socket, T> {};
+
 template <typename SOCKET>
 class socket_array : public sc_object
 {
@@ -131,12 +145,26 @@ public:
     typedef typename map_type::iterator iterator;
     typedef typename map_type::const_iterator const_iterator;
 
+    // sockets with indices below this limit are also kept in a flat table
+    // that allows lookups without hashing
+    static constexpr size_t DENSE_LIMIT = 4096;
+
 private:
     size_t m_next;
     size_t m_max;
     address_space m_space;
     map_type m_sockets;
     revmap_type m_ids;
+    vector<SOCKET*> m_dense;
+
+    SOCKET* lookup(size_t idx) const {
+        if (idx < m_dense.size())
+            return m_dense[idx];
+        if (idx < DENSE_LIMIT)
+            return nullptr;
+        auto it = m_sockets.find(idx);
+        return it != m_sockets.end() ? it->second : nullptr;
+    }
 
 public:
     property<bool> trace_all;
@@ -149,6 +177,7 @@ public:
         m_space(VCML_AS_DEFAULT),
         m_sockets(),
         m_ids(),
+        m_dense(),
         trace_all(this, "trace", false),
         trace_errors(this, "trace_errors", false) {
         trace_all.inherit_default();
@@ -180,7 +209,7 @@ public:
     const_iterator end() const { return m_sockets.cend(); }
 
     SOCKET& get(size_t idx) {
-        SOCKET*& socket = m_sockets[idx];
+        SOCKET* socket = lookup(idx);
         if (socket)
             return *socket;
 
@@ -193,31 +222,53 @@ public:
             socket->trace_errors.set_default(trace_errors);
         }
 
-        m_ids[socket] = idx;
+        if constexpr (supports_indexing<SOCKET>::value)
+            static_cast<base_socket*>(socket)->m_index = idx;
+        else
+            m_ids[socket] = idx;
+
+        if (idx < DENSE_LIMIT) {
+            if (idx >= m_dense.size())
+                m_dense.resize(idx + 1, nullptr);
+            m_dense[idx] = socket;
+        }
+
+        m_sockets[idx] = socket;
         m_next = max(m_next, idx + 1);
         return *socket;
     }
 
     SOCKET& operator[](size_t idx) { return get(idx); }
     const SOCKET& operator[](size_t idx) const {
-        VCML_ERROR_ON(!exists(idx), "socket %zu not found", idx);
-        return *m_sockets.at(idx);
+        const SOCKET* socket = lookup(idx);
+        VCML_ERROR_ON(!socket, "socket %zu not found", idx);
+        return *socket;
     }
 
     size_t count() const { return m_sockets.size(); }
-    bool exists(size_t idx) const { return stl_contains(m_sockets, idx); }
+    bool exists(size_t idx) const { return lookup(idx) != nullptr; }
     size_t next_index() const { return m_next; }
     SOCKET& next() { return operator[](next_index()); }
 
     bool contains(const SOCKET& socket) const {
-        return m_ids.find(&socket) != m_ids.end();
+        if constexpr (supports_indexing<SOCKET>::value)
+            return lookup(socket.index()) == &socket;
+        else
+            return m_ids.find(&socket) != m_ids.end();
     }
 
     size_t index_of(const SOCKET& socket) const {
-        auto it = m_ids.find(&socket);
-        if (it == m_ids.end())
-            VCML_ERROR("socket %s not part of %s", socket.name(), name());
-        return it->second;
+        if constexpr (supports_indexing<SOCKET>::value) {
+            size_t idx = socket.index();
+            if (lookup(idx) != &socket)
+                VCML_ERROR("socket %s not part of %s", socket.name(), name());
+            return idx;
+        } else {
+            auto it = m_ids.find(&socket);
+            if (it == m_ids.end())
+                VCML_ERROR("socket %s not part of %s", socket.name(), name());
+            return it->second;
+        }
     }
 
     set<size_t> all_keys() const {
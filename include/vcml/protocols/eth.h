@@ -68,6 +68,34 @@ struct mac_addr {
     }
 };
 
+// checksum and segmentation metadata that travels alongside a frame, its
+// layout of fields mirrors the virtio/tap vnet header
+struct eth_offload {
+    enum flags : u8 {
+        NEEDS_CSUM = bit(0),
+        DATA_VALID = bit(1),
+    };
+
+    enum gso_types : u8 {
+        GSO_NONE = 0,
+        GSO_TCPV4 = 1,
+        GSO_UDP = 3,
+        GSO_TCPV6 = 4,
+        GSO_ECN = 0x80,
+    };
+
+    u8 flags = 0;
+    u8 gso_type = GSO_NONE;
+    u16 hdr_len = 0;
+    u16 gso_size = 0;
+    u16 csum_start = 0;
+    u16 csum_offset = 0;
+
+    bool needs_csum() const { return flags & NEEDS_CSUM; }
+    bool data_valid() const { return flags & DATA_VALID; }
+    bool is_gso() const { return gso_type != GSO_NONE; }
+};
+
 struct eth_frame : public vector<u8> {
     enum : size_t {
         FRAME_HEADER_SIZE = 14,
@@ -104,6 +132,12 @@ struct eth_frame : public vector<u8> {
     eth_frame& operator=(const eth_frame&) = default;
     eth_frame& operator=(eth_frame&&) = default;
 
+    eth_offload offload;
+
+    // fills in a checksum left partial by the sender (NEEDS_CSUM), for
+    // receivers that cannot handle offloaded frames
+    bool complete_checksum();
+
     template <typename T>
     T read(size_t offset) const {
         T val = T();
@@ -182,6 +216,10 @@ public:
     eth_host(const eth_host&) = delete;
 
 protected:
+    // hosts returning true get frames with partial checksums as they were
+    // sent, all others receive frames with their checksums completed
+    virtual bool eth_rx_offload() const { return false; }
+
     virtual void eth_receive(const eth_target_socket&, const eth_frame& frame);
     virtual void eth_receive(const eth_frame& frame);
     virtual bool eth_rx_pop(eth_frame& frame);
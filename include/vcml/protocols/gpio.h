@@ -32,11 +32,48 @@ struct gpio_payload {
 
 ostream& operator<<(ostream& os, const gpio_payload& gpio);
 
+// updates up to 64 consecutive vectors starting at base in one transaction;
+// bit i of mask selects vector base + i and bit i of state is its new state,
+// targets report the vectors whose state actually flipped in changed
+struct gpio_bulk_payload {
+    gpio_vector base;
+    u64 mask;
+    u64 state;
+    u64 changed;
+
+    gpio_vector vector(size_t i) const { return base + i; }
+    bool state_of(size_t i) const { return (state >> i) & 1; }
+    gpio_payload payload(size_t i) const { return { vector(i), state_of(i) }; }
+};
+
+ostream& operator<<(ostream& os, const gpio_bulk_payload& gpio);
+
+class gpio_state
+{
+private:
+    bool m_novec;
+    vector<u64> m_bits;
+    unordered_set<gpio_vector> m_sparse;
+
+public:
+    // vectors below this limit are tracked in a bitmap, all others sparsely
+    static constexpr gpio_vector DENSE_LIMIT = 4096;
+
+    gpio_state(): m_novec(false), m_bits(), m_sparse() {}
+
+    bool read(gpio_vector vector) const;
+    bool write(gpio_vector vector, bool state);
+
+    u64 read_mask(gpio_vector base) const;
+    u64 write_mask(gpio_vector base, u64 mask, u64 state);
+};
+
 class gpio_fw_transport_if : public sc_core::sc_interface
 {
 public:
     typedef gpio_payload protocol_types;
     virtual void gpio_transport(gpio_payload& tx) = 0;
+    virtual void gpio_bulk_transport(gpio_bulk_payload& tx) = 0;
 };
 
 class gpio_bw_transport_if : public sc_core::sc_interface
@@ -60,6 +97,8 @@ public:
     gpio_host() = default;
     virtual ~gpio_host() = default;
     virtual void gpio_transport(const gpio_target_socket&, gpio_payload&) = 0;
+    virtual void gpio_bulk_transport(const gpio_target_socket& socket,
+                                     gpio_bulk_payload& tx);
 };
 
 typedef multi_initiator_socket<gpio_fw_transport_if, gpio_bw_transport_if>
@@ -115,10 +154,11 @@ using gpio_base_target_array = socket_array<gpio_base_target_socket>;
 class gpio_initiator_socket : public gpio_base_initiator_socket
 {
 public:
-    struct gpio_state_tracker : gpio_payload {
+    struct gpio_state_tracker {
         gpio_initiator_socket* parent;
-        bool read() const { return state; }
-        void write(bool val);
+        gpio_vector vector;
+        bool read() const { return parent->read(vector); }
+        void write(bool val) { parent->write(val, vector); }
         bool operator=(bool val);
         bool operator|=(bool val);
         bool operator&=(bool val);
@@ -136,6 +176,9 @@ public:
     operator bool() const { return read(GPIO_NO_VECTOR); }
     void write(bool state, gpio_vector vector = GPIO_NO_VECTOR);
 
+    u64 read_mask(gpio_vector base = 0) const;
+    void write_mask(u64 mask, u64 state, gpio_vector base = 0);
+
     void raise(gpio_vector vector = GPIO_NO_VECTOR);
     void lower(gpio_vector vector = GPIO_NO_VECTOR);
     void pulse(gpio_vector vector = GPIO_NO_VECTOR);
@@ -149,7 +192,8 @@ public:
 private:
     gpio_host* m_host;
     sc_event* m_event;
-    unordered_map<gpio_vector, gpio_state_tracker> m_state;
+    gpio_state m_state;
+    unordered_map<gpio_vector, gpio_state_tracker> m_trackers;
 
     struct gpio_bw_transport : public gpio_bw_transport_if {
         mutable gpio_initiator_socket* socket;
@@ -162,6 +206,7 @@ private:
     } m_transport;
 
     void gpio_transport(gpio_payload& tx);
+    void gpio_bulk_transport(gpio_bulk_payload& tx);
 };
 
 class gpio_target_socket : public gpio_base_target_socket
@@ -178,6 +223,7 @@ public:
     const sc_event& default_event();
 
     bool read(gpio_vector vector = GPIO_NO_VECTOR) const;
+    u64 read_mask(gpio_vector base = 0) const;
     bool operator[](gpio_vector vector) const { return read(vector); }
     operator bool() const { return read(GPIO_NO_VECTOR); }
 
@@ -187,7 +233,7 @@ public:
 private:
     gpio_host* m_host;
     sc_event* m_event;
-    unordered_map<gpio_vector, bool> m_state;
+    gpio_state m_state;
     gpio_base_initiator_socket* m_initiator;
     vector<gpio_base_target_socket*> m_targets;
 
@@ -200,15 +246,21 @@ private:
             socket->gpio_transport_internal(tx);
         }
 
+        virtual void gpio_bulk_transport(gpio_bulk_payload& tx) override {
+            socket->gpio_bulk_transport_internal(tx);
+        }
+
         virtual const sc_event& default_event() const override {
             return socket->default_event();
         }
     } m_transport;
 
     void gpio_transport_internal(gpio_payload& gpio);
+    void gpio_bulk_transport_internal(gpio_bulk_payload& gpio);
 
 protected:
     virtual void gpio_transport(gpio_payload& gpio);
+    virtual void gpio_bulk_transport(gpio_bulk_payload& gpio);
 };
 
 using gpio_initiator_array = socket_array<gpio_initiator_socket>;
@@ -226,6 +278,7 @@ class gpio_target_stub : private gpio_fw_transport_if
 {
 private:
     virtual void gpio_transport(gpio_payload& tx) override;
+    virtual void gpio_bulk_transport(gpio_bulk_payload& tx) override;
 
 public:
     gpio_base_target_socket gpio_in;
@@ -17,22 +17,36 @@
 
 namespace vcml {
 
+struct tlm_dmi_denial {
+    range addr;
+    vcml_access rwx;
+};
+
 class tlm_dmi_cache
 {
 private:
     mutable mutex m_mtx;
 
     size_t m_limit;
+    size_t m_deny_limit;
     vector<tlm_dmi> m_entries;
+    vector<tlm_dmi_denial> m_denied;
 
     void insert_locked(const tlm_dmi& dmi);
+    void allow_locked(const range& r);
 
 public:
     size_t get_entry_limit() const { return m_limit; }
     void set_entry_limit(size_t lim) { m_limit = lim; }
 
+    // denials are kept apart from grants, since an initiator may probe far
+    // more scattered mmio addresses than it has dmi regions
+    size_t get_denial_limit() const { return m_deny_limit; }
+    void set_denial_limit(size_t lim) { m_deny_limit = lim; }
+
     vector<tlm_dmi> get_entries() { return m_entries; }
     const vector<tlm_dmi>& get_entries() const { return m_entries; }
+    const vector<tlm_dmi_denial>& get_denied() const { return m_denied; }
 
     tlm_dmi_cache();
     virtual ~tlm_dmi_cache();
@@ -42,6 +56,13 @@ public:
     bool invalidate(u64 start, u64 end);
     bool invalidate(const range& r);
 
+    // remembers ranges for which a target refused DMI, so that they are not
+    // probed again until they get invalidated or a DMI grant covers them; a
+    // denial only holds for requests that need at least the refused access
+    void deny(const range& r, vcml_access rwx = VCML_ACCESS_READ);
+    void allow(const range& r);
+    bool is_denied(const range& r, vcml_access rwx = VCML_ACCESS_READ) const;
+
     bool lookup(const range& r, vcml_access rwx, tlm_dmi& dmi);
     bool lookup(const range& addr, tlm_command c, tlm_dmi& dmi);
     bool lookup(u64 addr, u64 size, tlm_command c, tlm_dmi& dmi);
@@ -28,12 +28,23 @@ struct exlock {
 class tlm_exmon
 {
 private:
-    vector<exlock> m_locks;
+    size_t m_count;
+    u64 m_maxlen;
+    vector<optional<range>> m_slots;
+    vector<bool> m_punched;
+    std::multimap<u64, int> m_index;
+    function<void(const range&)> m_release;
+
+    void remove_lock(int cpu);
+
+    template <typename FUNC>
+    void for_each_overlap(const range& r, FUNC fn) const;
 
 public:
-    const vector<exlock> get_locks() const { return m_locks; }
+    vector<exlock> get_locks() const;
+    bool has_locks() const { return m_count > 0; }
 
-    tlm_exmon() = default;
+    tlm_exmon();
     virtual ~tlm_exmon() = default;
 
     bool has_lock(int cpu, const range& r) const;
@@ -45,8 +56,33 @@ public:
     bool update(tlm_generic_payload& tx);
 
     bool override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi);
+
+    // invoked with the address range of every released lock that refused
+    // or shrunk a dmi request while it was held, other locks never affected
+    // any dmi mapping and are released silently
+    void on_release(function<void(const range&)> fn) {
+        m_release = std::move(fn);
+    }
 };
 
+template <typename FUNC>
+void tlm_exmon::for_each_overlap(const range& r, FUNC fn) const {
+    if (m_count == 0)
+        return;
+
+    // locks are indexed by start address, so only locks starting at most
+    // m_maxlen bytes before r can overlap with it
+    u64 lo = r.start > m_maxlen - 1 ? r.start - (m_maxlen - 1) : 0;
+    for (auto it = m_index.lower_bound(lo); it != m_index.end(); it++) {
+        if (it->first > r.end)
+            break;
+
+        const range& lock = *m_slots[it->second];
+        if (lock.overlaps(r))
+            fn(it->second, lock);
+    }
+}
+
 } // namespace vcml
 
 #endif
@@ -27,16 +27,24 @@ private:
     void* m_base;
     size_t m_size;
     bool m_discard;
+    bool m_attached;
     string m_shared;
 
     int init_shared(const string& shared, size_t size);
 
+    static vector<tlm_memory*>& shared_memories();
+
 public:
     u8* data() const { return get_dmi_ptr(); }
     size_t size() const { return dmi_get_size(*this); }
 
     bool is_shared() const { return !m_shared.empty(); }
     const char* shared_name() const { return m_shared.c_str(); }
+    size_t shared_size() const { return is_shared() ? m_size : 0; }
+
+    // finds the shared memory whose mapping contains ptr, so that other
+    // processes can map the same location using the name and offset
+    static const tlm_memory* find_shared(const void* ptr, size_t& offset);
 
     void allow_read_only() { allow_read(); }
     void allow_write_only() { allow_write(); }
@@ -54,6 +62,18 @@ public:
 
     void init(size_t size, alignment al);
     void init(const string& shared, size_t size, alignment al);
+
+    // maps an existing shared memory segment owned by another process, the
+    // segment is neither created nor unlinked here and find_shared will not
+    // report it, since it does not belong to any local memory
+    void attach(const string& shared, size_t size);
+
+    // replaces a shared mapping with a private copy at the same address, so
+    // that existing dmi pointers stay valid but writes are no longer seen
+    // by other processes, e.g. after forking the simulation
+    void unshare();
+    static void unshare_all();
+
     void free();
     void fill(u8 data);
 
@@ -77,6 +97,24 @@ public:
     u8& operator[](size_t offset);
 };
 
+inline vector<tlm_memory*>& tlm_memory::shared_memories() {
+    static vector<tlm_memory*> memories;
+    return memories;
+}
+
+inline const tlm_memory* tlm_memory::find_shared(const void* ptr,
+                                                 size_t& offset) {
+    for (const tlm_memory* mem : shared_memories()) {
+        const u8* base = (const u8*)mem->m_base;
+        if (ptr >= base && ptr < base + mem->m_size) {
+            offset = (const u8*)ptr - base;
+            return mem;
+        }
+    }
+
+    return nullptr;
+}
+
 inline void tlm_memory::init(size_t size, alignment al) {
     init("", size, al);
 }
@@ -31,6 +31,14 @@
 
 namespace vcml {
 
+// One piece of a vectored access: size bytes at bus address addr are
+// transferred from or to the local buffer data.
+struct tlm_segment {
+    u64 addr;
+    void* data;
+    unsigned int size;
+};
+
 class tlm_initiator_socket
     : public simple_initiator_socket<tlm_initiator_socket>
 {
@@ -49,6 +57,11 @@ private:
 
     void invalidate_direct_mem_ptr_int(sc_dt::uint64 start, sc_dt::uint64 end);
 
+    bool lookup_dmi_run(tlm_command cmd, const range& run, tlm_dmi& dmi);
+    tlm_response_status access_run(tlm_command cmd, const tlm_segment* segs,
+                                   size_t count, u64 size,
+                                   const tlm_sbi& info, unsigned int& nbytes);
+
 protected:
     virtual void invalidate_direct_mem_ptr(u64 start, u64 end);
 
@@ -99,6 +112,18 @@ public:
                               const tlm_sbi& info = SBI_NONE,
                               unsigned int* nbytes = nullptr);
 
+    tlm_response_status accessv(tlm_command cmd, const tlm_segment* segs,
+                                size_t count, const tlm_sbi& info = SBI_NONE,
+                                unsigned int* nbytes = nullptr);
+
+    tlm_response_status readv(const vector<tlm_segment>& segs,
+                              const tlm_sbi& info = SBI_NONE,
+                              unsigned int* nbytes = nullptr);
+
+    tlm_response_status writev(const vector<tlm_segment>& segs,
+                               const tlm_sbi& info = SBI_NONE,
+                               unsigned int* nbytes = nullptr);
+
     template <typename T>
     tlm_response_status readw(u64 addr, T& data,
                               const tlm_sbi& info = SBI_NONE,
@@ -176,6 +201,16 @@ inline tlm_response_status tlm_initiator_socket::write(u64 addr,
     return access(TLM_WRITE_COMMAND, addr, ptr, size, info, bytes);
 }
 
+inline tlm_response_status tlm_initiator_socket::readv(
+    const vector<tlm_segment>& segs, const tlm_sbi& info, unsigned int* n) {
+    return accessv(TLM_READ_COMMAND, segs.data(), segs.size(), info, n);
+}
+
+inline tlm_response_status tlm_initiator_socket::writev(
+    const vector<tlm_segment>& segs, const tlm_sbi& info, unsigned int* n) {
+    return accessv(TLM_WRITE_COMMAND, segs.data(), segs.size(), info, n);
+}
+
 template <typename T>
 inline tlm_response_status tlm_initiator_socket::readw(u64 addr, T& data,
                                                        const tlm_sbi& info,
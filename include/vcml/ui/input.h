@@ -64,6 +64,7 @@ private:
 
     mutable mutex m_mutex;
     queue<input_event> m_events;
+    function<void(void)> m_notify;
 
 protected:
     void push_event(const input_event& ev);
@@ -78,6 +79,10 @@ public:
 
     bool has_events() const;
     bool pop_event(input_event& ev);
+
+    // called from the producing thread whenever events become available
+    // after all previous ones have been popped, so consumers need not poll
+    void on_event(function<void(void)> notify);
 };
 
 class keyboard : public input
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_UI_SHMFB_H
+#define VCML_UI_SHMFB_H
+
+#include <stdint.h>
+
+/*
+ * Layout of the shared memory segment published by the "shm" display. This
+ * header is plain C, so that external viewers can map the segment without
+ * linking against vcml. The segment is named VCML_SHMFB_NAME with the display
+ * number filled in and starts with struct vcml_shmfb_header.
+ *
+ * Pixels are either found in this segment at fb_offset or, if fb_name is not
+ * empty, at fb_offset within the shared memory segment called fb_name. The
+ * latter happens if the guest framebuffer itself already lives in shared
+ * memory, in which case the simulator does not copy any pixels at all.
+ *
+ * The simulator increments seq after each update and stores the updated
+ * rectangle in damage[(seq - 1) % VCML_SHMFB_DAMAGE]. Viewers that fall more
+ * than VCML_SHMFB_DAMAGE updates behind should redraw the whole screen. To
+ * sleep until the next update, viewers increment waiters, wait on seq using
+ * FUTEX_WAIT and decrement waiters again afterwards. Once the simulator
+ * changes the video mode or terminates, state becomes VCML_SHMFB_CLOSED and
+ * viewers should unmap the segment and open it again.
+ */
+
+#define VCML_SHMFB_NAME    "/vcml-shmfb-%u"
+#define VCML_SHMFB_MAGIC   0x62666d73 /* "smfb" */
+#define VCML_SHMFB_VERSION 1
+#define VCML_SHMFB_DAMAGE  16
+
+enum vcml_shmfb_state {
+    VCML_SHMFB_ACTIVE = 1,
+    VCML_SHMFB_CLOSED = 2,
+};
+
+struct vcml_shmfb_channel {
+    uint8_t offset; /* offset in bits */
+    uint8_t size;   /* size in bits */
+};
+
+struct vcml_shmfb_rect {
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+};
+
+struct vcml_shmfb_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t state;
+    uint32_t seq;
+    uint32_t waiters;
+
+    uint32_t xres;
+    uint32_t yres;
+    uint32_t bpp;
+    uint32_t stride;
+    uint32_t big_endian;
+
+    struct vcml_shmfb_channel a;
+    struct vcml_shmfb_channel r;
+    struct vcml_shmfb_channel g;
+    struct vcml_shmfb_channel b;
+
+    char fb_name[64];
+    uint64_t fb_offset;
+    uint64_t fb_size;
+
+    struct vcml_shmfb_rect damage[VCML_SHMFB_DAMAGE];
+};
+
+#endif
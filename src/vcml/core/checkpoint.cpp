@@ -0,0 +1,301 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <filesystem>
+
+#include "vcml/core/checkpoint.h"
+#include "vcml/properties/broker.h"
+
+namespace vcml {
+
+static const char* const STATE_FILE = "state";
+static const char SPARSE_MAGIC[8] = { 'V', 'C', 'M', 'L', 'S', 'P', 'R', 'S' };
+
+static string escape_value(const string& s) {
+    string res;
+    res.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '\\':
+            res += "\\\\";
+            break;
+        case '\n':
+            res += "\\n";
+            break;
+        case '\r':
+            res += "\\r";
+            break;
+        default:
+            res += c;
+        }
+    }
+
+    return res;
+}
+
+static string unescape_value(const string& s) {
+    string res;
+    res.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] != '\\' || i + 1 == s.size()) {
+            res += s[i];
+            continue;
+        }
+
+        switch (s[++i]) {
+        case 'n':
+            res += '\n';
+            break;
+        case 'r':
+            res += '\r';
+            break;
+        default:
+            res += s[i];
+        }
+    }
+
+    return res;
+}
+
+static bool is_zero(const u8* data, size_t size) {
+    for (; size > 0 && ((uintptr_t)data % sizeof(u64)); data++, size--)
+        if (*data)
+            return false;
+    for (; size >= sizeof(u64); data += sizeof(u64), size -= sizeof(u64))
+        if (*(const u64*)data)
+            return false;
+    for (; size > 0; data++, size--)
+        if (*data)
+            return false;
+    return true;
+}
+
+static void zero_pages(u8* data, size_t start, size_t end) {
+    const size_t pgsz = checkpoint::SPARSE_PAGE_SIZE;
+    for (size_t pos = start; pos < end; pos += pgsz) {
+        size_t len = min(pgsz, end - pos);
+        if (!is_zero(data + pos, len))
+            memset(data + pos, 0, len);
+    }
+}
+
+string checkpoint::key(const string& name) const {
+    return m_scope.empty() ? name : m_scope + SC_HIERARCHY_CHAR + name;
+}
+
+string checkpoint::path(const string& name) const {
+    return mkstr("%s/%s", m_dir.c_str(), name.c_str());
+}
+
+void checkpoint::load() {
+    string file = path(STATE_FILE);
+    ifstream is(file);
+    VCML_REPORT_ON(!is, "cannot read checkpoint %s", file.c_str());
+
+    string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        size_t pos = line.find(" = ");
+        if (pos == string::npos) {
+            log_warn("ignoring malformed checkpoint entry: %s", line.c_str());
+            continue;
+        }
+
+        m_values[line.substr(0, pos)] = unescape_value(line.substr(pos + 3));
+    }
+}
+
+checkpoint::checkpoint(const string& dir, mode md):
+    m_mode(md),
+    m_dir(dir),
+    m_scope(),
+    m_scopes(),
+    m_time(sc_time_stamp()),
+    m_values(),
+    m_missing(0) {
+    if (is_saving()) {
+        std::error_code ec;
+        std::filesystem::create_directories(m_dir, ec);
+        VCML_REPORT_ON(ec, "cannot create checkpoint directory %s: %s",
+                       m_dir.c_str(), ec.message().c_str());
+    } else {
+        load();
+    }
+
+    u64 raw = m_time.value();
+    if (value("@time", raw))
+        m_time = time_from_value(raw);
+}
+
+void checkpoint::enter(const sc_object& obj) {
+    m_scopes.push_back(m_scope);
+    m_scope = obj.name();
+}
+
+void checkpoint::leave() {
+    VCML_ERROR_ON(m_scopes.empty(), "unmatched checkpoint scope");
+    m_scope = m_scopes.back();
+    m_scopes.pop_back();
+}
+
+bool checkpoint::has(const string& name) const {
+    return stl_contains(m_values, key(name));
+}
+
+bool checkpoint::value(const string& name, string& val) {
+    string k = key(name);
+    if (is_saving()) {
+        m_values[k] = val;
+        return true;
+    }
+
+    auto it = m_values.find(k);
+    if (it == m_values.end()) {
+        m_missing++;
+        return false;
+    }
+
+    val = it->second;
+    return true;
+}
+
+bool checkpoint::blob(const string& name, void* data, size_t size) {
+    static const char* const digits = "0123456789abcdef";
+    u8* bytes = (u8*)data;
+    string str;
+
+    if (is_saving()) {
+        str.reserve(size * 2);
+        for (size_t i = 0; i < size; i++) {
+            str += digits[bytes[i] >> 4];
+            str += digits[bytes[i] & 0xf];
+        }
+    }
+
+    if (!value(name, str))
+        return false;
+
+    if (is_restoring()) {
+        if (str.size() != size * 2) {
+            log_warn("checkpoint size mismatch for %s", key(name).c_str());
+            return false;
+        }
+
+        for (size_t i = 0; i < size; i++)
+            bytes[i] = strtoul(str.substr(i * 2, 2).c_str(), nullptr, 16);
+    }
+
+    return true;
+}
+
+bool checkpoint::sparse(const string& name, u8* data, size_t size) {
+    const size_t pgsz = SPARSE_PAGE_SIZE;
+    string file = key(name) + ".bin";
+    if (!value(name, file))
+        return false;
+
+    if (is_saving()) {
+        ofstream os(path(file), std::ios::binary);
+        VCML_REPORT_ON(!os, "cannot write %s", path(file).c_str());
+
+        u64 header[2] = { size, pgsz };
+        os.write(SPARSE_MAGIC, sizeof(SPARSE_MAGIC));
+        os.write((const char*)header, sizeof(header));
+
+        // only runs of non-zero pages are written to the file
+        size_t pos = 0;
+        while (pos < size) {
+            size_t len = min(pgsz, size - pos);
+            if (is_zero(data + pos, len)) {
+                pos += len;
+                continue;
+            }
+
+            size_t end = pos + len;
+            while (end < size) {
+                len = min(pgsz, size - end);
+                if (is_zero(data + end, len))
+                    break;
+                end += len;
+            }
+
+            u64 run[2] = { pos, end - pos };
+            os.write((const char*)run, sizeof(run));
+            os.write((const char*)data + pos, end - pos);
+            pos = end;
+        }
+
+        VCML_REPORT_ON(!os, "error writing %s", path(file).c_str());
+        return true;
+    }
+
+    ifstream is(path(file), std::ios::binary);
+    VCML_REPORT_ON(!is, "cannot read %s", path(file).c_str());
+
+    char magic[sizeof(SPARSE_MAGIC)];
+    u64 header[2] = {};
+    is.read(magic, sizeof(magic));
+    is.read((char*)header, sizeof(header));
+    VCML_REPORT_ON(!is || memcmp(magic, SPARSE_MAGIC, sizeof(magic)),
+                   "invalid sparse checkpoint file %s", path(file).c_str());
+    VCML_REPORT_ON(header[0] != size, "%s holds %zu bytes, expected %zu",
+                   path(file).c_str(), (size_t)header[0], size);
+
+    // pages outside of the recorded runs must read back as zero, but only
+    // those that are not already zero get touched
+    size_t pos = 0;
+    u64 run[2];
+    while (is.read((char*)run, sizeof(run))) {
+        VCML_REPORT_ON(run[0] < pos || run[1] > size - run[0],
+                       "corrupt sparse checkpoint file %s",
+                       path(file).c_str());
+        zero_pages(data, pos, run[0]);
+        is.read((char*)data + run[0], run[1]);
+        VCML_REPORT_ON(!is, "error reading %s", path(file).c_str());
+        pos = run[0] + run[1];
+    }
+
+    zero_pages(data, pos, size);
+    return true;
+}
+
+bool checkpoint::prop(property_base& prop, bool force) {
+    string val = is_saving() ? string(prop.str()) : string();
+    if (!value(prop.basename(), val))
+        return false;
+
+    if (is_restoring()) {
+        string init;
+        if (!force && broker::init(prop.fullname(), init))
+            return true;
+        prop.str(val);
+    }
+
+    return true;
+}
+
+void checkpoint::commit() {
+    if (!is_saving())
+        return;
+
+    string file = path(STATE_FILE);
+    ofstream os(file);
+    VCML_REPORT_ON(!os, "cannot write checkpoint %s", file.c_str());
+
+    os << "# vcml checkpoint" << std::endl;
+    for (const auto& val : m_values)
+        os << val.first << " = " << escape_value(val.second) << "\n";
+
+    VCML_REPORT_ON(!os, "error writing checkpoint %s", file.c_str());
+}
+
+} // namespace vcml
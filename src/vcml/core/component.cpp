@@ -98,6 +98,22 @@ void component::gpio_transport(const gpio_target_socket& socket,
     }
 }
 
+void component::gpio_bulk_transport(const gpio_target_socket& socket,
+                                    gpio_bulk_payload& tx) {
+    if (socket == rst)
+        gpio_host::gpio_bulk_transport(socket, tx);
+    else
+        gpio_bulk_notify(socket, tx.changed, tx.base);
+}
+
+void component::gpio_bulk_notify(const gpio_target_socket& socket,
+                                 u64 changed, gpio_vector base) {
+    for (; changed; changed &= changed - 1) {
+        gpio_vector vector = base + ctz(changed);
+        gpio_notify(socket, socket.read(vector), vector);
+    }
+}
+
 void component::gpio_notify(const gpio_target_socket& socket, bool state,
                             gpio_vector vector) {
     gpio_notify(socket, state);
@@ -10,6 +10,7 @@
 
 #include "vcml/core/version.h"
 #include "vcml/core/module.h"
+#include "vcml/core/register.h"
 
 namespace vcml {
 
@@ -83,6 +84,34 @@ void module::session_resume() {
     // to be overloaded
 }
 
+void module::serialize(checkpoint& ckpt) {
+    for (sc_attr_base* attr : attr_cltn()) {
+        property_base* prop = dynamic_cast<property_base*>(attr);
+        reg_base* reg = dynamic_cast<reg_base*>(attr);
+        if (prop != nullptr)
+            ckpt.prop(*prop, reg != nullptr);
+        if (reg != nullptr)
+            reg->serialize_banks(ckpt);
+    }
+}
+
+void module::fork_prepare() {
+    // to be overloaded
+}
+
+void module::fork_child(size_t id) {
+    // to be overloaded
+}
+
+string module::fork_expand(const string& tmpl, size_t id) {
+    const string key = "{fork}";
+    string str = tmpl;
+    size_t pos = 0;
+    while ((pos = str.find(key, pos)) != str.npos)
+        str.replace(pos, key.length(), to_string(id));
+    return str;
+}
+
 bool module::execute(const string& name, const vector<string>& args,
                      ostream& os) {
     command_base* cmd = get_command(name);
@@ -13,6 +13,45 @@
 
 namespace vcml {
 
+// byte-enabled pulses up to this width are forwarded as one masked access
+static constexpr unsigned int MAX_MASKED_WIDTH = 64;
+
+static unsigned int count_enabled(const u8* mask, u64 length) {
+    unsigned int n = 0;
+    for (u64 i = 0; i < length; i++)
+        n += mask[i] ? 1 : 0;
+    return n;
+}
+
+static bool any_lane_enabled(const range& tx, const range& reg,
+                             const u8* mask) {
+    range span = tx.intersect(reg);
+    return count_enabled(mask + span.start - tx.start, span.length()) > 0;
+}
+
+template <typename FUNC>
+static tlm_response_status split_masked(const range& addr, const u8* mask,
+                                        FUNC fn) {
+    tlm_response_status rs = TLM_INCOMPLETE_RESPONSE;
+    u64 len = addr.length();
+    for (u64 i = 0; i < len; i++) {
+        if (!mask[i])
+            continue;
+
+        u64 j = i;
+        while (j + 1 < len && mask[j + 1])
+            j++;
+
+        rs = fn(range(addr.start + i, addr.start + j), i);
+        if (rs != TLM_OK_RESPONSE)
+            return rs;
+
+        i = j;
+    }
+
+    return rs;
+}
+
 bool peripheral::cmd_mmap(const vector<string>& args, ostream& os) {
     os << "Memory map of " << name();
 
@@ -145,6 +184,27 @@ unsigned int peripheral::transport(tlm_generic_payload& tx,
             tx.set_data_length(swidth);
             tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
             nbytes += receive(tx, info, as);
+        } else if (swidth <= MAX_MASKED_WIDTH) {
+            u8 mask[MAX_MASKED_WIDTH];
+            bool all = true, none = true;
+            for (unsigned int byte = 0; byte < swidth; byte++) {
+                mask[byte] = be_ptr[be_index++ % be_length] ? 0xff : 0x00;
+                all &= mask[byte] != 0;
+                none &= mask[byte] == 0;
+            }
+
+            if (none)
+                continue;
+
+            tx.set_data_ptr(ptr + pulse * swidth);
+            tx.set_data_length(swidth);
+            tx.set_streaming_width(swidth);
+            tx.set_byte_enable_ptr(all ? nullptr : mask);
+            tx.set_byte_enable_length(all ? 0 : swidth);
+            tx.set_response_status(TLM_INCOMPLETE_RESPONSE);
+            nbytes += receive(tx, info, as);
+            tx.set_byte_enable_ptr(be_ptr);
+            tx.set_byte_enable_length(be_length);
         } else {
             for (unsigned int byte = 0; byte < swidth && !failed(tx); byte++) {
                 if (be_ptr[be_index++ % be_length]) {
@@ -189,16 +249,26 @@ unsigned int peripheral::receive(tlm_generic_payload& tx, const tlm_sbi& info,
         return 0;
     }
 
-    // no byte-enable support
-    if (tx.get_byte_enable_ptr() || tx.get_byte_enable_length()) {
+    // byte enables must cover the access exactly, one entry per byte
+    const u8* mask = tx.get_byte_enable_ptr();
+    if ((mask || tx.get_byte_enable_length()) &&
+        (!mask || tx.get_byte_enable_length() != tx.get_data_length())) {
         tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
         return 0;
     }
 
     set_current_cpu(info.cpuid);
 
+    bool skipped = false;
+    const range txaddr(tx);
     for (auto* reg : m_registers[as]) {
         if (reg->get_range().overlaps(tx)) {
+            // registers whose lanes are all disabled are not accessed at all
+            if (mask && !any_lane_enabled(txaddr, reg->get_range(), mask)) {
+                skipped = true;
+                continue;
+            }
+
             bytes += reg->receive(tx, info);
 
             if (success(tx) && reg->is_natural_accesses_only())
@@ -213,17 +283,31 @@ unsigned int peripheral::receive(tlm_generic_payload& tx, const tlm_sbi& info,
     if (success(tx) || failed(tx)) // stop if at least one reg took the access
         return bytes;
 
+    if (skipped) { // only disabled register lanes were hit
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return bytes;
+    }
+
     tlm_response_status rs = TLM_OK_RESPONSE;
     const range addr(tx);
-    if (tx.is_read())
-        rs = read(addr, tx.get_data_ptr(), info, as);
-    if (tx.is_write())
-        rs = write(addr, tx.get_data_ptr(), info, as);
+    if (tx.is_read()) {
+        rs = mask ? read(addr, tx.get_data_ptr(), mask, info, as)
+                  : read(addr, tx.get_data_ptr(), info, as);
+    }
+
+    if (tx.is_write()) {
+        rs = mask ? write(addr, tx.get_data_ptr(), mask, info, as)
+                  : write(addr, tx.get_data_ptr(), info, as);
+    }
 
     if (rs == TLM_INCOMPLETE_RESPONSE)
         rs = TLM_ADDRESS_ERROR_RESPONSE;
     tx.set_response_status(rs);
-    return tx.is_response_ok() ? addr.length() : 0;
+
+    if (!tx.is_response_ok())
+        return 0;
+
+    return mask ? count_enabled(mask, addr.length()) : addr.length();
 }
 
 tlm_response_status peripheral::read(const range& addr, void* data,
@@ -246,6 +330,26 @@ tlm_response_status peripheral::write(const range& addr, const void* data,
     return TLM_INCOMPLETE_RESPONSE; // to be overloaded
 }
 
+tlm_response_status peripheral::read(const range& addr, void* data,
+                                     const u8* mask, const tlm_sbi& info,
+                                     address_space as) {
+    // to be overloaded, by default only the enabled bytes are read
+    u8* ptr = (u8*)data;
+    return split_masked(addr, mask, [&](const range& r, u64 off) {
+        return read(r, ptr + off, info, as);
+    });
+}
+
+tlm_response_status peripheral::write(const range& addr, const void* data,
+                                      const u8* mask, const tlm_sbi& info,
+                                      address_space as) {
+    // to be overloaded, by default only the enabled bytes are written
+    const u8* ptr = (const u8*)data;
+    return split_masked(addr, mask, [&](const range& r, u64 off) {
+        return write(r, ptr + off, info, as);
+    });
+}
+
 void peripheral::handle_clock_update(hz_t oldclk, hz_t newclk) {
     const sc_time rlat = clock_cycles(read_latency);
     const sc_time wlat = clock_cycles(write_latency);
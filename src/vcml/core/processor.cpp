@@ -242,16 +242,125 @@ bool processor::cmd_gdb(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool processor::cmd_profile(const vector<string>& args, ostream& os) {
+    string file = args.empty() ? profile.get() : args[0];
+    if (file.empty()) {
+        os << "Usage: profile <file>";
+        return false;
+    }
+
+    write_profile(file);
+    os << "written " << m_profile_samples << " samples to " << file;
+    return true;
+}
+
 u64 processor::simulate_cycles(size_t cycles) {
     u64 count = cycle_count();
     double start = mwr::timestamp();
     set_suspendable(false);
-    simulate(cycles);
+    if (profile.get().empty())
+        simulate(cycles);
+    else
+        simulate_profiled(cycles);
     set_suspendable(true);
     m_run_time += mwr::timestamp() - start;
     return cycle_count() - count;
 }
 
+void processor::simulate_profiled(size_t cycles) {
+    // samples are taken between calls to simulate, so the quantum is split
+    // up at the sampling points; this runs on the processor's own thread,
+    // which is the only one touching the profile while simulating
+    while (cycles > 0) {
+        u64 now = cycle_count();
+        if (now >= m_profile_next) {
+            sample_profile();
+            m_profile_next = now + profile_cycles();
+        }
+
+        simulate(min<u64>(cycles, m_profile_next - now));
+
+        u64 done = cycle_count() - now;
+        if (done == 0)
+            break;
+
+        cycles -= min<u64>(cycles, done);
+    }
+}
+
+u64 processor::profile_cycles() const {
+    if (profile_interval > 0u)
+        return profile_interval;
+
+    sc_time cycle = clock_cycle();
+    if (cycle == SC_ZERO_TIME)
+        return 1;
+
+    return max<u64>(profile_period.get() / cycle, 1);
+}
+
+void processor::sample_profile() {
+    vector<u64> stack;
+    if (profile_depth > 1u) {
+        stacktrace(m_profile_trace, profile_depth);
+        for (const auto& frame : m_profile_trace)
+            stack.push_back(frame.program_counter);
+    } else {
+        stack.push_back(program_counter());
+    }
+
+    m_profile[stack]++;
+    m_profile_samples++;
+}
+
+void processor::write_profile(const string& file) const {
+    // folded stack format: one line per call stack, outermost frame first
+    // and separated by semicolons, followed by the number of samples
+    std::map<string, size_t> folded;
+    for (const auto& sample : m_profile) {
+        string line;
+        for (auto it = sample.first.rbegin(); it != sample.first.rend();
+             it++) {
+            const debugging::symbol* sym = symbols().find_function(*it);
+            if (!line.empty())
+                line += ";";
+            line += sym ? string(sym->name()) : mkstr("0x%016llx", *it);
+        }
+
+        folded[line] += sample.second;
+    }
+
+    ofstream os(file.c_str());
+    if (!os.good()) {
+        log_warn("cannot write profile to '%s'", file.c_str());
+        return;
+    }
+
+    for (const auto& line : folded)
+        os << line.first << " " << line.second << "\n";
+
+    log_debug("written %zu profile samples to '%s'", m_profile_samples,
+              file.c_str());
+}
+
+bool processor::can_skip_idle() const {
+    return idle_skip && !is_stepping() && is_running() && is_idle();
+}
+
+void processor::skip_idle() {
+    // catch up with local time, afterwards nothing can happen before the
+    // next scheduled event, so we can jump there directly
+    sync();
+
+    sc_time delta = sc_core::sc_time_to_pending_activity();
+    if (idle_limit.get() > SC_ZERO_TIME)
+        delta = min(delta, idle_limit.get());
+
+    sc_time start = sc_time_stamp();
+    wait(delta, m_wakeup);
+    m_idle_time += sc_time_stamp() - start;
+}
+
 void processor::processor_thread() {
     wait(SC_ZERO_TIME);
 
@@ -262,7 +371,9 @@ void processor::processor_thread() {
         // check for standby requests
         wait_clock_reset();
 
-        if (async && !is_stepping()) {
+        // idle processors are handled on the kernel thread, which can skip
+        // ahead to the next event directly
+        if (async && !is_stepping() && !can_skip_idle()) {
             vcml::sc_async([&]() { running = processor_thread_async(); });
         } else {
             running = processor_thread_sync();
@@ -270,7 +381,7 @@ void processor::processor_thread() {
 
         // check that local time advanced beyond quantum start time
         // if we fail here, we most likely have a broken cycle_count()
-        if (local_time_stamp() == now)
+        if (local_time_stamp() == now && !can_skip_idle())
             VCML_ERROR("processor %s is stuck in time", name());
     }
 }
@@ -309,6 +420,10 @@ bool processor::processor_thread_async() {
             update_local_time(lt, current_process());
             sc_progress(lt);
             lt = SC_ZERO_TIME;
+
+            // hand over to the kernel thread for skipping idle time
+            if (can_skip_idle())
+                return true;
         }
 
         while (sim_running() && async_time_offset() >= quantum)
@@ -344,7 +459,9 @@ bool processor::processor_thread_sync() {
 
         if (is_stepping() && num_cycles > 0)
             notify_singlestep();
-        if (is_running() && num_cycles == 0)
+        if (can_skip_idle())
+            skip_idle();
+        else if (is_running() && num_cycles == 0)
             wait(quantum - local_time());
     } while (!needs_sync());
 
@@ -361,6 +478,14 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     m_gdb(nullptr),
     m_irq_stats(),
     m_regprops(),
+    m_wakeup(mkstr("%s_wakeup", basename()).c_str()),
+    m_idle_time(),
+    m_profile_next(0),
+    m_profile_samples(0),
+    m_profile(),
+    m_profile_trace(),
+    m_fetch_tags(),
+    m_fetch_data(),
     cpuarch("arch", cpuarch),
     symbols("symbols"),
     gdb_wait("gdb_wait", false),
@@ -369,12 +494,31 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     gdb_term("gdb_term", "gdbterm"),
     async("async", false),
     async_rate("async_rate", 5),
+    idle_skip("idle_skip", true),
+    idle_limit("idle_limit", sc_time(10.0, SC_MS)),
+    profile("profile", ""),
+    profile_interval("profile_interval", 0),
+    profile_period("profile_period", sc_time(10.0, SC_US)),
+    profile_depth("profile_depth", 1),
+    fetch_cache("fetch_cache", false),
+    fetch_cache_line("fetch_cache_line", 64),
+    fetch_cache_lines("fetch_cache_lines", 64),
     irq("irq"),
     insn("insn"),
     data("data") {
     SC_HAS_PROCESS(processor);
     SC_THREAD(processor_thread);
 
+    if (fetch_cache) {
+        if (!is_pow2(fetch_cache_line) || !fetch_cache_lines) {
+            log_warn("invalid fetch cache geometry %zu x %llu bytes",
+                     fetch_cache_lines.get(), fetch_cache_line.get());
+        } else {
+            m_fetch_tags.resize(fetch_cache_lines, ~0ull);
+            m_fetch_data.resize(fetch_cache_lines * fetch_cache_line);
+        }
+    }
+
     if (!symbols.get().empty()) {
         vector<string> symfiles = split(symbols);
         for (auto symfile : symfiles) {
@@ -408,6 +552,9 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
                      "generates a stack trace for the current function");
     register_command("gdb", 0, &processor::cmd_gdb,
                      "opens a new gdb debug session");
+    register_command("profile", 0, &processor::cmd_profile,
+                     "writes sampled program counters as folded stacks, "
+                     "usage: profile [file]");
 }
 
 processor::~processor() {
@@ -422,11 +569,74 @@ void processor::reset() {
 
     m_cycle_count = 0;
     m_run_time = 0.0;
+    m_idle_time = SC_ZERO_TIME;
+    m_profile_next = 0;
 
     for (auto reg : m_regprops)
         reg.second->reset();
 
     flush_cpuregs();
+    flush_fetch_cache();
+}
+
+const u8* processor::fetch_line(u64 addr, size_t size) {
+    const u64 linesz = fetch_cache_line;
+    const u64 base = addr & ~(linesz - 1);
+    if (addr + size > base + linesz)
+        return nullptr;
+
+    // regions with dmi are fast already and are kept coherent by the target
+    tlm_dmi dmi;
+    if (insn.allow_dmi &&
+        insn.dmi_cache().lookup(addr, size, TLM_READ_COMMAND, dmi))
+        return nullptr;
+
+    size_t idx = (base / linesz) % m_fetch_tags.size();
+    u8* line = m_fetch_data.data() + idx * linesz;
+    if (m_fetch_tags[idx] == base)
+        return line + (addr - base);
+
+    m_fetch_tags[idx] = ~0ull;
+    if (failed(insn.read(base, line, linesz)))
+        return nullptr;
+
+    // no need to keep the line if the fill has just granted dmi
+    if (insn.allow_dmi && insn.dmi_cache().lookup(base, linesz,
+                                                  TLM_READ_COMMAND, dmi))
+        return line + (addr - base);
+
+    m_fetch_tags[idx] = base;
+    return line + (addr - base);
+}
+
+void processor::flush_fetch_cache() {
+    std::fill(m_fetch_tags.begin(), m_fetch_tags.end(), ~0ull);
+}
+
+void processor::flush_fetch_cache(u64 start, u64 end) {
+    if (m_fetch_tags.empty() || start > end)
+        return;
+
+    const u64 linesz = fetch_cache_line;
+    if (end - start >= linesz * m_fetch_tags.size()) {
+        flush_fetch_cache();
+        return;
+    }
+
+    for (u64 base = start & ~(linesz - 1); base <= end; base += linesz) {
+        size_t idx = (base / linesz) % m_fetch_tags.size();
+        if (m_fetch_tags[idx] == base)
+            m_fetch_tags[idx] = ~0ull;
+        if (base + linesz < base)
+            break;
+    }
+}
+
+void processor::invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                          u64 start, u64 end) {
+    if (&origin == &insn)
+        flush_fetch_cache(start, end);
+    component::invalidate_direct_mem_ptr(origin, start, end);
 }
 
 void processor::session_suspend() {
@@ -439,11 +649,25 @@ void processor::session_resume() {
     flush_cpuregs();
 }
 
-bool processor::get_irq_stats(size_t irq, irq_stats& stats) const {
-    if (m_irq_stats.find(irq) == m_irq_stats.end())
+void processor::serialize(checkpoint& ckpt) {
+    if (ckpt.is_saving())
+        fetch_cpuregs();
+
+    component::serialize(ckpt);
+
+    // cpu registers are always restored, even if configured otherwise
+    for (auto& reg : m_regprops)
+        ckpt.prop(*reg.second, true);
+
+    if (ckpt.is_restoring())
+        flush_cpuregs();
+}
+
+bool processor::get_irq_stats(size_t irqno, irq_stats& stats) const {
+    if (irqno >= m_irq_stats.size() || !irq.exists(irqno))
         return false;
 
-    stats = m_irq_stats.at(irq);
+    stats = m_irq_stats[irqno];
     return true;
 }
 
@@ -477,7 +701,11 @@ void processor::log_bus_error(const tlm_initiator_socket& socket,
 void processor::gpio_notify(const gpio_target_socket& socket, bool state,
                             gpio_vector vector) {
     size_t irqno = irq.index_of(socket);
+    if (irqno >= m_irq_stats.size())
+        m_irq_stats.resize(irqno + 1, irq_stats());
+
     irq_stats& stats = m_irq_stats[irqno];
+    stats.irq = irqno;
 
     if (state == stats.irq_status) {
         log_warn("irq %zu already %s", irqno, state ? "set" : "cleared");
@@ -498,6 +726,7 @@ void processor::gpio_notify(const gpio_target_socket& socket, bool state,
 
     log_debug("%sing IRQ %zu", state ? "sett" : "clear", irqno);
     interrupt(irqno, state, vector);
+    m_wakeup.notify();
 }
 
 void processor::interrupt(size_t irq, bool set, gpio_vector vector) {
@@ -517,12 +746,20 @@ void processor::update_local_time(sc_time& local_time, sc_process_b* proc) {
     }
 }
 
+void processor::end_of_simulation() {
+    component::end_of_simulation();
+
+    if (!profile.get().empty())
+        write_profile(profile);
+}
+
 void processor::end_of_elaboration() {
     component::end_of_elaboration();
 
-    for (auto it : irq) {
-        irq_stats& stats = m_irq_stats[it.first];
-        stats.irq = it.first;
+    m_irq_stats.assign(irq.next_index(), irq_stats());
+    for (size_t irqno = 0; irqno < m_irq_stats.size(); irqno++) {
+        irq_stats& stats = m_irq_stats[irqno];
+        stats.irq = irqno;
         stats.irq_count = 0;
         stats.irq_status = false;
         stats.irq_last = SC_ZERO_TIME;
@@ -648,10 +885,11 @@ u64 processor::read_pmem_dbg(u64 addr, void* buffer, u64 size) {
 
 u64 processor::write_pmem_dbg(u64 addr, const void* buffer, u64 size) {
     try {
-        if (success(data.write(addr, buffer, size, SBI_DEBUG)))
-            return size;
-        if (success(insn.write(addr, buffer, size, SBI_DEBUG)))
+        if (success(data.write(addr, buffer, size, SBI_DEBUG)) ||
+            success(insn.write(addr, buffer, size, SBI_DEBUG))) {
+            flush_fetch_cache(addr, addr + size - 1);
             return size;
+        }
     } catch (report& r) {
         log_warn("error writing %llu bytes to memory at address 0x%llx: %s",
                  size, addr, r.message());
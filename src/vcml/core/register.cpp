@@ -17,6 +17,10 @@ int reg_base::current_cpu() const {
     return m_host->current_cpu();
 }
 
+sc_time reg_base::local_time_stamp() const {
+    return m_host->local_time_stamp();
+}
+
 reg_base::reg_base(address_space space, const string& regname, u64 addr,
                    u64 cell_size, u64 cell_count):
     sc_object(regname.c_str()),
@@ -68,27 +72,103 @@ void reg_base::do_receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     }
 
     unsigned char* ptr = tx.get_data_ptr();
-    if (m_host->endian != host_endian()) // i.e. if big endian
-        memswap(ptr, tx.get_data_length());
+    unsigned char* mask = tx.get_byte_enable_ptr();
+    unsigned int size = tx.get_data_length();
 
-    if (tx.is_read())
-        do_read(tx, ptr);
-    if (tx.is_write())
-        do_write(tx, ptr);
+    if (m_host->endian != host_endian()) { // i.e. if big endian
+        memswap(ptr, size);
+        if (mask)
+            memswap(mask, size);
+    }
 
-    if (m_host->endian != host_endian()) // i.e. swap back
-        memswap(ptr, tx.get_data_length());
+    if (tx.is_read()) {
+        if (mask)
+            do_read_masked(tx, ptr, mask);
+        else
+            do_read(tx, ptr);
+    }
+
+    if (tx.is_write()) {
+        if (mask)
+            do_write_masked(tx, ptr, mask);
+        else
+            do_write(tx, ptr);
+    }
+
+    if (m_host->endian != host_endian()) { // i.e. swap back
+        memswap(ptr, size);
+        if (mask)
+            memswap(mask, size);
+    }
 
     tx.set_response_status(TLM_OK_RESPONSE);
 }
 
+void reg_base::do_read_masked(const range& addr, void* ptr, const u8* mask) {
+    u8 buffer[64];
+    vector<u8> large;
+    u8* data = buffer;
+    if (m_cell_size > sizeof(buffer)) {
+        large.resize(m_cell_size);
+        data = large.data();
+    }
+
+    // read cell by cell, skipping cells without any enabled bytes so that
+    // read side effects only happen for lanes that were actually accessed
+    u8* dest = (u8*)ptr;
+    u64 pos = addr.start;
+    while (pos <= addr.end) {
+        u64 off = pos % m_cell_size;
+        u64 size = min(addr.end - pos + 1, m_cell_size - off);
+        const u8* lanes = mask + pos - addr.start;
+
+        bool enabled = false;
+        for (u64 i = 0; i < size && !enabled; i++)
+            enabled = lanes[i] != 0;
+
+        if (enabled) {
+            do_read(range(pos, pos + size - 1), data);
+            for (u64 i = 0; i < size; i++)
+                if (lanes[i])
+                    dest[pos - addr.start + i] = data[i];
+        }
+
+        pos += size;
+    }
+}
+
+void reg_base::serialize_banks(checkpoint& ckpt) {
+    // to be overloaded
+}
+
+void reg_base::do_write_masked(const range& addr, const void* ptr,
+                               const u8* mask) {
+    // fallback for registers without merge support: write enabled runs
+    const u8* src = (const u8*)ptr;
+    u64 len = addr.length();
+    for (u64 i = 0; i < len; i++) {
+        if (!mask[i])
+            continue;
+
+        u64 j = i;
+        while (j + 1 < len && mask[j + 1])
+            j++;
+
+        do_write(range(addr.start + i, addr.start + j), src + i);
+        i = j;
+    }
+}
+
 unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     u64 addr = tx.get_address();
     u64 size = tx.get_data_length();
     u64 strw = tx.get_streaming_width();
     u8* data = tx.get_data_ptr();
+    u8* mask = tx.get_byte_enable_ptr();
+    u64 mlen = tx.get_byte_enable_length();
 
     VCML_ERROR_ON(strw != size, "invalid transaction streaming setup");
+    VCML_ERROR_ON(mask && mlen != size, "invalid byte enable setup");
     VCML_ERROR_ON(!m_range.overlaps(tx), "invalid register access");
     VCML_ERROR_ON(m_cell_size == 0, "cell size cannot be zero");
 
@@ -104,6 +184,11 @@ unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     tx.set_streaming_width(span.length());
     tx.set_data_length(span.length());
 
+    if (mask) {
+        tx.set_byte_enable_ptr(mask + span.start - addr);
+        tx.set_byte_enable_length(span.length());
+    }
+
     if (!info.is_debug) {
         if (tx.is_read() && m_rsync)
             m_host->sync();
@@ -119,8 +204,19 @@ unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     tx.set_data_length(size);
     tx.set_streaming_width(strw);
     tx.set_data_ptr(data);
+    tx.set_byte_enable_ptr(mask);
+    tx.set_byte_enable_length(mlen);
+
+    if (!tx.is_response_ok())
+        return 0;
+
+    if (mask == nullptr)
+        return span.length();
 
-    return tx.is_response_ok() ? span.length() : 0;
+    unsigned int bytes = 0;
+    for (u64 i = span.start - addr; i <= span.end - addr; i++)
+        bytes += mask[i] ? 1 : 0;
+    return bytes;
 }
 
 } // namespace vcml
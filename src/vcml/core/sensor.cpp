@@ -0,0 +1,100 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/sensor.h"
+
+namespace vcml {
+
+void sensor::rearm() {
+    m_event.cancel();
+
+    sc_time next = SC_MAX_TIME;
+    for (double threshold : m_thresholds)
+        next = min(next, time_to(threshold));
+
+    if (next != SC_MAX_TIME)
+        m_event.notify(next);
+}
+
+double sensor::value_at(const sc_time& t) const {
+    if (m_rate == 0.0 || t <= m_start)
+        return m_value;
+
+    double val = m_value + m_rate * (t - m_start).to_seconds();
+    if (m_rate > 0.0)
+        return min(val, m_target);
+    return max(val, m_target);
+}
+
+bool sensor::is_static() const {
+    return m_rate == 0.0 || value() == m_target;
+}
+
+sensor::sensor(const char* nm, double init):
+    sc_object(nm),
+    m_value(init),
+    m_target(init),
+    m_rate(0.0),
+    m_start(SC_ZERO_TIME),
+    m_thresholds(),
+    m_event(mkstr("%s_event", basename()).c_str()) {
+    // nothing to do
+}
+
+void sensor::set(double val) {
+    m_value = m_target = val;
+    m_rate = 0.0;
+    m_start = sc_time_stamp();
+
+    // a jump may skip across any threshold, let the owner reevaluate
+    m_event.cancel();
+    m_event.notify(SC_ZERO_TIME);
+}
+
+void sensor::ramp(double target, double rate_per_sec) {
+    if (rate_per_sec <= 0.0) {
+        set(target);
+        return;
+    }
+
+    m_value = value();
+    m_target = target;
+    m_rate = target < m_value ? -rate_per_sec : rate_per_sec;
+    m_start = sc_time_stamp();
+    rearm();
+}
+
+sc_time sensor::time_to(double threshold) const {
+    double val = value();
+    double dist = 0.0;
+
+    if (m_rate > 0.0 && val < threshold && threshold <= m_target)
+        dist = threshold - val;
+    else if (m_rate < 0.0 && val > threshold && threshold >= m_target)
+        dist = val - threshold;
+    else
+        return SC_MAX_TIME;
+
+    // round up to make sure the threshold has been passed by then
+    return sc_time(dist / std::abs(m_rate), SC_SEC) +
+           sc_get_time_resolution();
+}
+
+void sensor::watch(const vector<double>& thresholds) {
+    m_thresholds = thresholds;
+    rearm();
+}
+
+void sensor::unwatch() {
+    m_thresholds.clear();
+    m_event.cancel();
+}
+
+} // namespace vcml
@@ -10,6 +10,12 @@
 
 #include "vcml/core/system.h"
 
+#ifdef MWR_LINUX
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 namespace vcml {
 
 static mwr::option<bool> list_properties("--list-properties",
@@ -31,6 +37,32 @@ static void list_object_properties(sc_object* obj) {
         list_object_properties(child);
 }
 
+static void serialize_objects(checkpoint& ckpt, sc_object* obj = nullptr) {
+    module* mod = dynamic_cast<module*>(obj);
+    if (mod != nullptr) {
+        ckpt.enter(*mod);
+        mod->serialize(ckpt);
+        ckpt.leave();
+    }
+
+    const auto& children = obj ? obj->get_child_objects()
+                               : sc_core::sc_get_top_level_objects();
+    for (auto child : children)
+        serialize_objects(ckpt, child);
+}
+
+static void for_each_module(const function<void(module&)>& fn,
+                            sc_object* obj = nullptr) {
+    module* mod = dynamic_cast<module*>(obj);
+    if (mod != nullptr)
+        fn(*mod);
+
+    const auto& children = obj ? obj->get_child_objects()
+                               : sc_core::sc_get_top_level_objects();
+    for (auto child : children)
+        for_each_module(fn, child);
+}
+
 SC_HAS_PROCESS(system);
 
 void system::timeout() {
@@ -41,8 +73,68 @@ void system::timeout() {
     }
 }
 
+void system::checkpoint_thread() {
+    wait(checkpoint_at);
+    on_next_update([&]() -> void { save_checkpoint(checkpoint_dir); });
+}
+
+void system::fork_thread() {
+    if (fork_count > 0) {
+        wait(fork_at);
+        m_fork_requested = fork_count;
+    }
+
+    while (m_fork_requested == 0)
+        wait(m_fork_ev);
+
+    fork_simulation(m_fork_requested.exchange(0));
+}
+
+bool system::cmd_checkpoint(const vector<string>& args, ostream& os) {
+    save_checkpoint(args[0]);
+    os << "checkpoint written to " << args[0];
+    return true;
+}
+
+bool system::cmd_restore(const vector<string>& args, ostream& os) {
+    restore_checkpoint(args[0]);
+    os << "checkpoint restored from " << args[0];
+    return true;
+}
+
+bool system::cmd_fork(const vector<string>& args, ostream& os) {
+    if (is_fork_child()) {
+        os << "cannot fork from a forked child";
+        return false;
+    }
+
+    size_t count = from_string<size_t>(args[0]);
+    if (count == 0) {
+        os << "invalid number of children: " << args[0];
+        return false;
+    }
+
+    request_fork(count);
+    os << "forking into " << count << " children at next update";
+    return true;
+}
+
+void system::exit_fork_child(int status) {
+#ifdef MWR_LINUX
+    // host threads started before the fork only exist in the parent, so the
+    // child must not run destructors that would try to join them
+    log_info("child %zu exiting with status %d", m_fork_id, status);
+    fflush(nullptr);
+    _exit(status);
+#endif
+}
+
 system::system(const sc_module_name& nm):
     module(nm),
+    m_fork_id(0),
+    m_fork_requested(0),
+    m_fork_ev("fork_ev"),
+    m_fork_status(EXIT_SUCCESS),
     name("name", mwr::progname()),
     desc("desc", mwr::progname()),
     config("config", ""),
@@ -50,13 +142,33 @@ system::system(const sc_module_name& nm):
     session("session", -1),
     session_debug("session_debug", false),
     quantum("quantum", sc_time(1, SC_US)),
-    duration("duration", SC_ZERO_TIME) {
+    duration("duration", SC_ZERO_TIME),
+    checkpoint_dir("checkpoint_dir", ""),
+    checkpoint_at("checkpoint_at", SC_ZERO_TIME),
+    restore("restore", ""),
+    fork_at("fork_at", SC_ZERO_TIME),
+    fork_count("fork_count", 0) {
     if (backtrace)
         mwr::report_segfaults();
 
     if (duration > SC_ZERO_TIME)
         SC_THREAD(timeout);
 
+    if (!checkpoint_dir.get().empty() && checkpoint_at > SC_ZERO_TIME)
+        SC_THREAD(checkpoint_thread);
+
+    SC_THREAD(fork_thread);
+
+    register_command("checkpoint", 1, &system::cmd_checkpoint,
+                     "saves the simulation state into the given directory, "
+                     "usage: checkpoint <dir>");
+    register_command("restore", 1, &system::cmd_restore,
+                     "restores the simulation state from the given "
+                     "directory, usage: restore <dir>");
+    register_command("fork", 1, &system::cmd_fork,
+                     "forks the simulation into the given number of child "
+                     "processes at the next update, usage: fork <n>");
+
     if (config.get().empty())
         log_warn("no configuration specified, use -f <config>");
 }
@@ -65,6 +177,115 @@ system::~system() {
     // nothing to do
 }
 
+void system::save_checkpoint(const string& dir) {
+    checkpoint ckpt(dir, checkpoint::CHECKPOINT_SAVE);
+    serialize_objects(ckpt);
+    ckpt.commit();
+
+    log_info("checkpoint written to %s at %s", dir.c_str(),
+             ckpt.time().to_string().c_str());
+}
+
+void system::restore_checkpoint(const string& dir) {
+    checkpoint ckpt(dir, checkpoint::CHECKPOINT_RESTORE);
+    serialize_objects(ckpt);
+
+    log_info("restored checkpoint %s taken at %s", dir.c_str(),
+             ckpt.time().to_string().c_str());
+    if (ckpt.missing() > 0)
+        log_warn("%zu entries missing from checkpoint", ckpt.missing());
+}
+
+void system::request_fork(size_t count) {
+    m_fork_requested = count;
+    on_next_update([&]() -> void { m_fork_ev.notify(SC_ZERO_TIME); });
+}
+
+void system::fork_simulation(size_t count) {
+#ifdef MWR_LINUX
+    VCML_ERROR_ON(!is_thread(), "fork_simulation must be called from thread");
+    VCML_ERROR_ON(is_fork_child(), "cannot fork from a forked child");
+
+    log_info("forking into %zu children at %s", count,
+             sc_time_stamp().to_string().c_str());
+
+    // let running async jobs finish their quantum while parking new ones, so
+    // that no async worker is mid-job when its host thread disappears
+    sc_async_hold();
+    while (!sc_async_idle())
+        wait(quantum.get());
+
+    for_each_module([](module& mod) { mod.fork_prepare(); });
+    fflush(nullptr);
+
+    vector<pid_t> children;
+    for (size_t id = 1; id <= count; id++) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            log_error("failed to fork child %zu: %s", id, strerror(errno));
+            break;
+        }
+
+        if (pid == 0) {
+            m_fork_id = id;
+            sc_async_respawn();
+            // shared memories would otherwise be written by all children
+            tlm_memory::unshare_all();
+            for_each_module([id](module& mod) { mod.fork_child(id); });
+            if (debugging::vspserver::instance())
+                debugging::vspserver::instance()->detach();
+            sc_async_release();
+            log_info("running as child %zu of %zu", id, count);
+            return;
+        }
+
+        children.push_back(pid);
+    }
+
+    // the original process only supervises its children from now on, its
+    // backends have been released and must not be used concurrently
+    m_fork_status = children.size() == count ? EXIT_SUCCESS : EXIT_FAILURE;
+    for (size_t i = 0; i < children.size(); i++) {
+        int status = 0;
+        if (waitpid(children[i], &status, 0) < 0) {
+            log_error("failed to wait for child %zu: %s", i + 1,
+                      strerror(errno));
+            m_fork_status = EXIT_FAILURE;
+        } else if (WIFEXITED(status)) {
+            log_info("child %zu exited with status %d", i + 1,
+                     WEXITSTATUS(status));
+            if (WEXITSTATUS(status) != EXIT_SUCCESS)
+                m_fork_status = EXIT_FAILURE;
+        } else {
+            log_error("child %zu terminated by signal %d", i + 1,
+                      WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+            m_fork_status = EXIT_FAILURE;
+        }
+    }
+
+    sc_async_release();
+    request_stop();
+#else
+    log_warn("forking is not supported on this platform");
+#endif
+}
+
+void system::start_of_simulation() {
+    module::start_of_simulation();
+
+    // the initial reset pulse has been sent during elaboration already, so
+    // restored state will not be overwritten by it
+    if (!restore.get().empty())
+        restore_checkpoint(restore);
+}
+
+void system::end_of_simulation() {
+    module::end_of_simulation();
+
+    if (!checkpoint_dir.get().empty() && checkpoint_at == SC_ZERO_TIME)
+        save_checkpoint(checkpoint_dir);
+}
+
 int system::run() {
     if (list_properties) {
         list_object_properties(this);
@@ -74,11 +295,14 @@ int system::run() {
     broker::report_unused();
     tlm::tlm_global_quantum::instance().set(quantum);
 
+    int status = EXIT_SUCCESS;
     try {
         if (session >= 0) {
             vcml::debugging::vspserver vspsession(session);
             vspsession.echo(session_debug);
             vspsession.start();
+            if (is_fork_child())
+                exit_fork_child(EXIT_SUCCESS);
         } else if (duration != sc_core::SC_ZERO_TIME) {
             log_info("starting simulation until %s using %s quantum",
                      duration.get().to_string().c_str(),
@@ -93,16 +317,20 @@ int system::run() {
         }
     } catch (sc_report& rep) {
         log_error("%s", rep.what());
-        return EXIT_FAILURE;
+        status = EXIT_FAILURE;
     } catch (std::exception& ex) {
         log_error("Caught c++ exception: %s", ex.what());
-        return EXIT_FAILURE;
+        status = EXIT_FAILURE;
     } catch (...) {
         log_error("Caught unknown exception");
-        return EXIT_FAILURE;
+        status = EXIT_FAILURE;
     }
 
-    return EXIT_SUCCESS;
+    if (is_fork_child())
+        exit_fork_child(status);
+
+    // a forked parent reports the combined status of its children
+    return status == EXIT_SUCCESS ? m_fork_status : status;
 }
 
 } // namespace vcml
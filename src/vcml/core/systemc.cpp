@@ -11,6 +11,7 @@
 #include "vcml/core/version.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/thctl.h"
+#include "vcml/core/mpsc.h"
 
 namespace vcml {
 
@@ -285,7 +286,15 @@ public:
 
     mutex mtx;
 
-    vector<function<void(void)>> next_update;
+    // callbacks and timers posted from other threads travel through lock-free
+    // queues and are drained in batches during the next update phase; the
+    // overflow lists are only used when the queues are full
+    mpsc_queue<function<void(void)>, 1024> next_update;
+    mpsc_queue<async_timer::event*, 1024> new_timers;
+    vector<function<void(void)>> next_update_overflow;
+    vector<async_timer::event*> new_timers_overflow;
+    atomic<bool> overflow;
+    atomic<bool> update_requested;
 
     vector<function<void(void)>> end_of_elab;
     vector<function<void(void)>> start_of_sim;
@@ -302,12 +311,21 @@ public:
     };
 
     sc_event timeout_event;
+    sc_event async_release;
     priority_queue<async_timer::event*, vector<async_timer::event*>,
                    timer_compare>
         timers;
 
+    void request_update() {
+        if (!update_requested.exchange(true))
+            async_request_update();
+    }
+
+    void fetch_timers() {
+        new_timers.drain([&](async_timer::event* ev) { timers.push(ev); });
+    }
+
     vector<async_timer::event*> pending_timers() {
-        lock_guard<mutex> guard(mtx);
         vector<async_timer::event*> pending;
         sc_time now = sc_time_stamp();
 
@@ -324,7 +342,7 @@ public:
     }
 
     void update_timer() {
-        lock_guard<mutex> guard(mtx);
+        fetch_timers();
 
         if (timers.empty()) {
             timeout_event.cancel();
@@ -350,22 +368,58 @@ public:
     }
 
     void add_timer(async_timer::event* ev) {
-        lock_guard<mutex> guard(mtx);
-        timers.push(ev);
-        async_request_update();
+        if (!new_timers.push(ev)) {
+            lock_guard<mutex> guard(mtx);
+            new_timers_overflow.push_back(ev);
+            overflow = true;
+        }
+
+        request_update();
+    }
+
+    void add_update(function<void(void)>&& fn) {
+        // once callbacks have spilled into the overflow list, newer ones must
+        // queue up behind them until the next update phase has drained it
+        if (overflow || !next_update.push(std::move(fn))) {
+            lock_guard<mutex> guard(mtx);
+            if (overflow || !next_update.push(std::move(fn))) {
+                next_update_overflow.push_back(std::move(fn));
+                overflow = true;
+            }
+        }
+
+        request_update();
     }
 
     void update() override {
-        update_timer();
+        update_requested = false;
 
         vector<function<void(void)>> curr_update;
+        if (overflow) {
+            // the queue only holds callbacks older than the overflow list,
+            // new ones go to the overflow list until it has been taken over
+            next_update.drain([](function<void(void)>& fn) { fn(); });
+
+            lock_guard<mutex> guard(mtx);
+            for (auto* ev : new_timers_overflow)
+                timers.push(ev);
+            new_timers_overflow.clear();
+            std::swap(curr_update, next_update_overflow);
+            overflow = false;
+        }
 
-        mtx.lock();
-        std::swap(curr_update, next_update);
-        mtx.unlock();
+        update_timer();
 
         for (auto& fn : curr_update)
             fn();
+
+        // drain at most one queue worth of callbacks per update phase, so that
+        // callbacks that keep posting new ones cannot starve the kernel
+        size_t budget = next_update.capacity();
+        next_update.drain([](function<void(void)>& fn) { fn(); }, budget);
+
+        if (!next_update.empty() || overflow)
+            request_update();
     }
 
     VCML_KIND(helper_module);
@@ -379,12 +433,19 @@ public:
         sim_running(true),
         use_phase_callbacks(kernel_has_phase_callbacks()),
         mtx(),
+        next_update(),
+        new_timers(),
+        next_update_overflow(),
+        new_timers_overflow(),
+        overflow(false),
+        update_requested(false),
         end_of_elab(),
         start_of_sim(),
         end_of_sim(),
         deltas(),
         tsteps(),
         timeout_event("timeout_ev"),
+        async_release("async_release_ev"),
         timers() {
 #if SYSTEMC_VERSION >= SYSTEMC_VERSION_2_3_1a && \
     SYSTEMC_VERSION < SYSTEMC_VERSION_3_0_0
@@ -451,6 +512,10 @@ public:
         sc_core::sc_unregister_stage_callback(
             *this, sc_core::SC_POST_UPDATE | sc_core::SC_PRE_TIMESTEP);
 #endif
+        fetch_timers();
+        for (auto* ev : new_timers_overflow)
+            delete ev;
+
         while (!timers.empty()) {
             delete timers.top();
             timers.pop();
@@ -499,9 +564,7 @@ helper_module& g_helper = helper_module::instance();
 
 void on_next_update(function<void(void)> callback) {
     helper_module& helper = helper_module::instance();
-    lock_guard<mutex> guard(helper.mtx);
-    helper.next_update.push_back(std::move(callback));
-    helper.async_request_update();
+    helper.add_update(std::move(callback));
 }
 
 void on_end_of_elaboration(function<void(void)> callback) {
@@ -534,6 +597,29 @@ void on_each_time_step(function<void(void)> callback) {
     helper.tsteps.push_back(std::move(callback));
 }
 
+async_event::async_event(const char* nm):
+    m_event(nm), m_state(std::make_shared<state>()) {
+    m_state->event = &m_event;
+    m_state->pending = false;
+}
+
+async_event::~async_event() {
+    m_state->event = nullptr;
+}
+
+void async_event::notify() {
+    if (m_state->pending.exchange(true))
+        return;
+
+    // the state outlives this object in case it is gone before the update
+    shared_ptr<state> s = m_state;
+    on_next_update([s]() -> void {
+        s->pending = false;
+        if (s->event)
+            s->event->notify(SC_ZERO_TIME);
+    });
+}
+
 async_timer::async_timer(function<void(async_timer&)> cb):
     m_triggers(0), m_timeout(), m_event(nullptr), m_cb(std::move(cb)) {
 }
@@ -675,29 +761,68 @@ struct async_worker {
 
     sc_time timestamp() { return sc_thread_pos + time_from_value(progress); }
 
+    typedef unordered_map<sc_process_b*, shared_ptr<async_worker>> map;
+
+    static map& workers() {
+        static map instances;
+        return instances;
+    }
+
     static async_worker& lookup(sc_process_b* thread) {
         VCML_ERROR_ON(!thread, "invalid thread");
 
-        typedef unordered_map<sc_process_b*, shared_ptr<async_worker>> map;
-        static map workers;
-
-        auto it = workers.find(thread);
-        if (it != workers.end())
+        auto it = workers().find(thread);
+        if (it != workers().end())
             return *it->second;
 
-        size_t id = workers.size();
+        size_t id = workers().size();
         auto worker = std::make_shared<async_worker>(id, thread);
-        return *(workers[thread] = worker);
+        return *(workers()[thread] = worker);
     }
 };
 
+static atomic<bool> g_async_hold(false);
+
 void sc_async(function<void(void)> job) {
     auto thread = current_thread();
     VCML_ERROR_ON(!thread, "sc_async must be called from SC_THREAD");
+
+    while (g_async_hold)
+        sc_core::wait(g_helper.async_release);
+
     async_worker& worker = async_worker::lookup(thread);
     worker.run_async(job);
 }
 
+void sc_async_hold() {
+    g_async_hold = true;
+}
+
+void sc_async_release() {
+    g_async_hold = false;
+    g_helper.async_release.notify(SC_ZERO_TIME);
+}
+
+bool sc_async_idle() {
+    for (const auto& it : async_worker::workers())
+        if (it.second->working)
+            return false;
+    return true;
+}
+
+void sc_async_respawn() {
+    VCML_ERROR_ON(!sc_async_idle(), "cannot respawn busy async workers");
+
+    // after fork() the worker objects refer to host threads that only exist
+    // in the parent; destroying them would attempt to join those threads,
+    // so they are handed over to a list that is intentionally never freed
+    static auto* orphans = new vector<shared_ptr<async_worker>>();
+    for (auto& it : async_worker::workers()) {
+        orphans->push_back(it.second);
+        it.second = std::make_shared<async_worker>(it.second->id, it.first);
+    }
+}
+
 void sc_progress(const sc_time& delta) {
     VCML_ERROR_ON(!g_async, "no async thread to progress");
     g_async->progress += delta.value();
@@ -396,7 +396,7 @@ void vspserver::resume_simulation(const sc_time& duration) {
 }
 
 void vspserver::pause_simulation(const string& reason) {
-    if (!is_suspending()) {
+    if (!m_detached && !is_suspending()) {
         m_stop_reason = reason;
         sc_pause();
         suspend();
@@ -435,7 +435,8 @@ vspserver::vspserver(u16 server_port):
     subscriber(),
     m_announce(mwr::temp_dir() + mkstr("/vcml_session_%hu", port())),
     m_stop_reason("elaboration"),
-    m_duration() {
+    m_duration(),
+    m_detached(false) {
     VCML_ERROR_ON(session != nullptr, "vspserver already created");
     session = this;
     atexit(&cleanup_session);
@@ -486,12 +487,25 @@ void vspserver::start() {
             sc_start(m_duration);
             pause_simulation("step");
         }
+
+        if (m_detached) {
+            if (sim_running())
+                sc_start();
+            break;
+        }
     }
 
-    if (is_connected())
+    if (is_connected() && !m_detached)
         disconnect();
 }
 
+void vspserver::detach() {
+    // the server thread and its client only exist in the original process,
+    // a forked child must not wait for requests that will never arrive
+    m_detached = true;
+    m_duration = SC_MAX_TIME;
+}
+
 void vspserver::cleanup() {
     if (!mwr::file_exists(m_announce))
         return;
@@ -58,6 +58,7 @@ disk::disk(const sc_module_name& nm, const string& img, bool ro):
     m_backend(nullptr),
     stats(),
     image("image", img),
+    fork_image("fork_image", ""),
     serial("serial", default_serial()),
     readonly("readonly", ro) {
     try {
@@ -73,6 +74,44 @@ disk::~disk() {
         delete m_backend;
 }
 
+void disk::fork_prepare() {
+    if (m_backend)
+        flush();
+}
+
+void disk::fork_child(size_t id) {
+    // ramdisks are duplicated copy-on-write by fork, writable image files
+    // would be shared though, unless each child gets its own overlay copy
+    if (!m_backend || m_backend->readonly())
+        return;
+    if (strcmp(m_backend->type(), "file") != 0)
+        return;
+
+    if (fork_image.get().empty()) {
+        log_warn("image '%s' shared by forked children", image.c_str());
+        return;
+    }
+
+    string path = fork_expand(fork_image, id);
+    try {
+        ofstream stream(path.c_str(), ofstream::binary | ofstream::trunc);
+        VCML_REPORT_ON(!stream.good(), "cannot open '%s'", path.c_str());
+
+        size_t pos = m_backend->pos();
+        m_backend->seek(0);
+        m_backend->save(stream);
+        stream.close();
+
+        backend* overlay = backend::create(path, false);
+        overlay->seek(pos);
+        delete m_backend;
+        m_backend = overlay;
+    } catch (std::exception& ex) {
+        log_warn("failed to create overlay '%s': %s", path.c_str(),
+                 ex.what());
+    }
+}
+
 size_t disk::capacity() {
     return m_backend ? m_backend->capacity() : 0;
 }
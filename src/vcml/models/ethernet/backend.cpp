@@ -36,6 +36,11 @@ void backend::send_to_guest(eth_frame frame) {
     m_parent->send_to_guest(std::move(frame));
 }
 
+void backend::send_to_guest(const u8* data, size_t len,
+                            const eth_offload& offload) {
+    m_parent->send_to_guest(data, len, offload);
+}
+
 backend* backend::create(bridge* br, const string& type) {
     string kind = type.substr(0, type.find(':'));
     typedef function<backend*(bridge*, const string&)> construct;
@@ -10,7 +10,10 @@
 
 #include "vcml/models/ethernet/backend_slirp.h"
 
-#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace vcml {
 namespace ethernet {
@@ -103,7 +106,8 @@ static void slirp_timer_mod(void* t, int64_t expire_time, void* opaque) {
 }
 
 static void slirp_register_poll_fd(int fd, void* opaque) {
-    // nothing to do
+    slirp_network* network = (slirp_network*)opaque;
+    network->wakeup(); // make sure the new fd gets polled right away
 }
 
 static void slirp_unregister_poll_fd(int fd, void* opaque) {
@@ -111,7 +115,8 @@ static void slirp_unregister_poll_fd(int fd, void* opaque) {
 }
 
 static void slirp_notify(void* opaque) {
-    // nothing to do
+    slirp_network* network = (slirp_network*)opaque;
+    network->wakeup();
 }
 
 static const SlirpCb SLIRP_CBS = {
@@ -130,26 +135,47 @@ void slirp_network::slirp_thread() {
     mwr::set_thread_name(mkstr("slirp_%u", m_id));
 
     while (m_running) {
-        unsigned int timeout = 10; // ms
-        vector<pollfd> fds;
+        // slirp shortens this according to its own tcp timer deadlines
+        u32 timeout = 1000; // ms
+
+        m_fds.clear();
+        m_fds.push_back({ m_wakefd[0], POLLIN, 0 });
 
         m_mtx.lock();
-        slirp_pollfds_fill(m_slirp, &timeout, &slirp_add_poll_fd, &fds);
+        slirp_pollfds_fill(m_slirp, &timeout, &slirp_add_poll_fd, &m_fds);
         m_mtx.unlock();
 
-        if (fds.empty()) {
-            mwr::usleep(timeout * 1000);
-            continue;
-        }
+        int ret = poll(m_fds.data(), m_fds.size(), timeout);
+        if (ret > 0 && (m_fds[0].revents & POLLIN))
+            drain_wakeup();
+
+        if (!m_running)
+            break;
+
+        // always poll slirp, even on timeout, so that its timers run
+        lock_guard<mutex> guard(m_mtx);
+        slirp_pollfds_poll(m_slirp, ret < 0, &slirp_get_events, &m_fds);
+    }
+}
+
+void slirp_network::drain_wakeup() {
+    m_wake_pending = false;
 
-        int ret = poll(fds.data(), fds.size(), timeout);
-        if (ret != 0) {
-            lock_guard<mutex> guard(m_mtx);
-            slirp_pollfds_poll(m_slirp, ret < 0, &slirp_get_events, &fds);
-        }
+    u8 buf[64];
+    while (read(m_wakefd[0], buf, sizeof(buf)) > 0) {
+        // drain all pending wakeups
     }
 }
 
+void slirp_network::wakeup() {
+    if (m_wake_pending.exchange(true))
+        return;
+
+    u8 val = 1;
+    if (write(m_wakefd[1], &val, sizeof(val)) < 0)
+        m_wake_pending = false;
+}
+
 slirp_network::slirp_network(unsigned int id):
     m_id(id),
     m_config(),
@@ -157,7 +183,16 @@ slirp_network::slirp_network(unsigned int id):
     m_clients(),
     m_mtx(),
     m_running(true),
-    m_thread() {
+    m_thread(),
+    m_wakefd(),
+    m_wake_pending(false),
+    m_fds() {
+    if (pipe(m_wakefd) < 0)
+        VCML_REPORT("failed to create slirp wakeup pipe: %s", strerror(errno));
+
+    for (int fd : m_wakefd)
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
     m_config.version = 1;
 
     m_config.in_enabled = true;
@@ -199,9 +234,13 @@ slirp_network::slirp_network(unsigned int id):
 
 slirp_network::~slirp_network() {
     m_running = false;
+    wakeup();
     if (m_thread.joinable())
         m_thread.join();
 
+    for (int fd : m_wakefd)
+        close(fd);
+
     for (auto client : m_clients)
         client->disconnect();
 
@@ -210,14 +249,17 @@ slirp_network::~slirp_network() {
 }
 
 void slirp_network::send_packet(const u8* ptr, size_t len) {
-    eth_frame frame(ptr, len);
     for (auto client : m_clients)
-        client->send_to_guest(frame);
+        client->send_to_guest(ptr, len, eth_offload());
 }
 
 void slirp_network::recv_packet(const u8* ptr, size_t len) {
     lock_guard<mutex> guard(m_mtx);
     slirp_input(m_slirp, ptr, len);
+
+    // slirp may have opened new sockets or queued data for the host, so
+    // have the poll loop pick them up immediately
+    wakeup();
 }
 
 void slirp_network::register_client(backend_slirp* client) {
@@ -232,6 +274,7 @@ backend_slirp::backend_slirp(bridge* br, const shared_ptr<slirp_network>& n):
     backend(br), m_network(n) {
     VCML_ERROR_ON(!m_network, "no network");
     m_network->register_client(this);
+    m_type = mkstr("slirp:%u", m_network->id());
 }
 
 backend_slirp::~backend_slirp() {
@@ -249,10 +292,16 @@ backend* backend_slirp::create(bridge* br, const string& type) {
     if (sscanf(type.c_str(), "slirp:%u", &netid) != 1)
         netid = 0;
 
-    static unordered_map<unsigned int, shared_ptr<slirp_network>> networks;
-    auto& network = networks[netid];
-    if (network == nullptr)
+    // networks only live as long as they have clients: bridges release all
+    // their backends before a fork, which stops the poll threads and frees
+    // the locks, so that forked children start over with fresh networks
+    static unordered_map<unsigned int, std::weak_ptr<slirp_network>> networks;
+    shared_ptr<slirp_network> network = networks[netid].lock();
+    if (network == nullptr) {
         network = std::make_shared<slirp_network>(netid);
+        networks[netid] = network;
+    }
+
     return new backend_slirp(br, network);
 }
 
@@ -20,6 +20,8 @@
 #include <libslirp.h>
 #include <libslirp-version.h>
 
+#include <poll.h>
+
 namespace vcml {
 namespace ethernet {
 
@@ -39,12 +41,21 @@ private:
     atomic<bool> m_running;
     thread m_thread;
 
+    int m_wakefd[2];
+    atomic<bool> m_wake_pending;
+    vector<pollfd> m_fds;
+
     void slirp_thread();
+    void drain_wakeup();
 
 public:
+    unsigned int id() const { return m_id; }
+
     slirp_network(unsigned int id);
     virtual ~slirp_network();
 
+    void wakeup();
+
     void send_packet(const u8* ptr, size_t len);
     void recv_packet(const u8* ptr, size_t len);
 
@@ -12,6 +12,8 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <unistd.h>
@@ -23,54 +25,217 @@
 namespace vcml {
 namespace ethernet {
 
-static bool tap_read(int fd, vector<u8>& buf) {
-    size_t len;
-    buf.resize(eth_frame::FRAME_MAX_SIZE);
+// legacy virtio net header prepended to each frame with IFF_VNET_HDR
+struct tap_vnet_hdr {
+    u8 flags;
+    u8 gso_type;
+    u16 hdr_len;
+    u16 gso_size;
+    u16 csum_start;
+    u16 csum_offset;
+};
 
-    do {
-        len = read(fd, buf.data(), buf.size());
-    } while (len < 0 && errno == EINTR);
+// large enough to hold anything the kernel might hand us, so that oversized
+// frames are dropped as a whole instead of being truncated
+static constexpr size_t TAP_BUFFER_SIZE = 65536;
+
+static int tap_open(char* name, int flags) {
+    int fd = open("/dev/net/tun", O_RDWR);
+    if (fd < 0)
+        return -1;
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = flags;
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
 
-    if (len < 0)
-        return false;
+    if (ioctl(fd, TUNSETIFF, (void*)&ifr) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
 
-    buf.resize(len);
-    return true;
+    strncpy(name, ifr.ifr_name, IFNAMSIZ - 1);
+    return fd;
 }
 
 void backend_tap::close_tap() {
-    if (m_fd >= 0) {
-        mwr::aio_cancel(m_fd);
-        close(m_fd);
-        m_fd = -1;
+    m_running = false;
+    if (m_thread.joinable()) {
+        u8 val = 1;
+        if (write(m_wakefd[1], &val, sizeof(val)) < 0)
+            log_warn("cannot wake tap thread: %s", strerror(errno));
+        m_thread.join();
+    }
+
+    for (int fd : m_wakefd) {
+        if (fd >= 0)
+            close(fd);
     }
+
+    for (int fd : m_fds)
+        close(fd);
+
+    m_wakefd[0] = m_wakefd[1] = -1;
+    m_fds.clear();
 }
 
-backend_tap::backend_tap(bridge* br, int devno): backend(br) {
-    m_fd = open("/dev/net/tun", O_RDWR);
-    VCML_REPORT_ON(m_fd < 0, "error opening tundev: %s", strerror(errno));
+bool backend_tap::tap_read(size_t queue) {
+    int fd = m_fds[queue];
+    vector<u8>& buf = m_buffers[queue];
+    size_t hdrsz = m_vnet ? sizeof(tap_vnet_hdr) : 0;
 
-    struct ifreq ifr;
-    memset(&ifr, 0, sizeof(ifr));
-    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
-    snprintf(ifr.ifr_name, IFNAMSIZ, "tap%d", devno);
+    // drain everything the device has queued up, the descriptor is
+    // non-blocking so we stop once the kernel reports EAGAIN
+    while (true) {
+        tap_vnet_hdr hdr{};
+        struct iovec iov[2];
+        int iovcnt = 0;
 
-    int err = ioctl(m_fd, TUNSETIFF, (void*)&ifr);
-    VCML_REPORT_ON(err < 0, "error creating tapdev: %s", strerror(errno));
-    log_info("using tap device %s", ifr.ifr_name);
+        if (m_vnet)
+            iov[iovcnt++] = { &hdr, sizeof(hdr) };
+        iov[iovcnt++] = { buf.data(), buf.size() };
 
-    m_type = mkstr("tap:%d", devno);
+        ssize_t len = readv(fd, iov, iovcnt);
+        if (len < 0 && errno == EINTR)
+            continue;
+
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
 
-    mwr::aio_notify(m_fd, [&](int fd) -> void {
-        eth_frame frame;
-        if (!tap_read(fd, frame)) {
+        if (len < 0) {
             log_error("error reading tap device: %s", strerror(errno));
-            mwr::aio_cancel(fd);
-            return;
+            return false;
+        }
+
+        if ((size_t)len <= hdrsz)
+            return true;
+
+        size_t size = len - hdrsz;
+        if (size > eth_frame::FRAME_MAX_SIZE || hdr.gso_type) {
+            log_debug("dropping oversized frame (%zu bytes)", size);
+            continue;
         }
 
-        send_to_guest(std::move(frame));
-    });
+        eth_offload offload;
+        offload.flags = hdr.flags & (eth_offload::NEEDS_CSUM |
+                                     eth_offload::DATA_VALID);
+        offload.csum_start = hdr.csum_start;
+        offload.csum_offset = hdr.csum_offset;
+        send_to_guest(buf.data(), size, offload);
+    }
+}
+
+void backend_tap::tap_thread() {
+    mwr::set_thread_name(m_type);
+
+    // the first entry is the wakeup pipe, queues that failed are disabled by
+    // negating their descriptor, which makes poll skip them
+    vector<pollfd> fds;
+    fds.push_back({ m_wakefd[0], POLLIN, 0 });
+    for (int fd : m_fds)
+        fds.push_back({ fd, POLLIN, 0 });
+
+    while (m_running) {
+        int ret = poll(fds.data(), fds.size(), 1000);
+        if (ret < 0 && errno != EINTR) {
+            log_error("error polling tap device: %s", strerror(errno));
+            break;
+        }
+
+        if (ret <= 0 || !m_running)
+            continue;
+
+        for (size_t q = 0; q < m_fds.size(); q++) {
+            pollfd& pfd = fds[q + 1];
+            if (pfd.revents & (POLLIN | POLLERR | POLLHUP)) {
+                if (!tap_read(q))
+                    pfd.fd = -1;
+            }
+        }
+    }
+}
+
+size_t backend_tap::select_queue(const eth_frame& frame) const {
+    if (m_fds.size() < 2 || frame.size() < 38)
+        return 0;
+
+    // keep packets of one flow on the same queue, so that the kernel
+    // does not reorder them
+    u32 hash = frame.destination().hash_crc32();
+    if (bswap(frame.read<u16>(12)) == eth_frame::ETHER_TYPE_IPV4)
+        hash = crc32(frame.data() + 26, 12); // addresses and ports
+    return hash % m_fds.size();
+}
+
+backend_tap::backend_tap(bridge* br, int devno, size_t queues):
+    backend(br),
+    m_fds(),
+    m_buffers(),
+    m_vnet(true),
+    m_running(true),
+    m_thread(),
+    m_wakefd() {
+    VCML_REPORT_ON(queues == 0, "tap device needs at least one queue");
+
+    char name[IFNAMSIZ];
+    snprintf(name, sizeof(name), "tap%d", devno);
+
+    int flags = IFF_TAP | IFF_NO_PI | IFF_VNET_HDR;
+    if (queues > 1)
+        flags |= IFF_MULTI_QUEUE;
+
+    int fd = tap_open(name, flags);
+    if (fd < 0) {
+        log_debug("tap offloading unavailable: %s", strerror(errno));
+        flags = IFF_TAP | IFF_NO_PI;
+        queues = 1;
+        m_vnet = false;
+        fd = tap_open(name, flags);
+    }
+
+    VCML_REPORT_ON(fd < 0, "error creating tapdev: %s", strerror(errno));
+    m_fds.push_back(fd);
+
+    while (m_fds.size() < queues) {
+        fd = tap_open(name, flags);
+        if (fd < 0) {
+            log_warn("error opening tap queue %zu: %s", m_fds.size(),
+                     strerror(errno));
+            break;
+        }
+
+        m_fds.push_back(fd);
+    }
+
+    for (int tapfd : m_fds) {
+        if (m_vnet) {
+            int hdrsz = sizeof(tap_vnet_hdr);
+            int err = ioctl(tapfd, TUNSETVNETHDRSZ, &hdrsz);
+            VCML_REPORT_ON(err < 0, "error setting tap header size: %s",
+                           strerror(errno));
+        }
+
+        int fl = fcntl(tapfd, F_GETFL);
+        VCML_REPORT_ON(fl < 0 || fcntl(tapfd, F_SETFL, fl | O_NONBLOCK) < 0,
+                       "error configuring tapdev: %s", strerror(errno));
+    }
+
+    log_info("using tap device %s (%zu queue%s%s)", name, m_fds.size(),
+             m_fds.size() > 1 ? "s" : "", m_vnet ? ", vnet header" : "");
+
+    m_type = mkstr("tap:%d", devno);
+    if (m_fds.size() > 1)
+        m_type += mkstr(":%zu", m_fds.size());
+
+    m_buffers.resize(m_fds.size(), vector<u8>(TAP_BUFFER_SIZE));
+
+    // each backend polls its queues from its own thread instead of a shared
+    // one, which would not survive when the simulation gets forked
+    VCML_REPORT_ON(pipe(m_wakefd) < 0, "error creating tap wakeup pipe: %s",
+                   strerror(errno));
+    m_thread = thread(&backend_tap::tap_thread, this);
 }
 
 backend_tap::~backend_tap() {
@@ -78,15 +243,43 @@ backend_tap::~backend_tap() {
 }
 
 void backend_tap::send_to_host(const eth_frame& frame) {
-    if (m_fd >= 0)
-        mwr::fd_write(m_fd, frame.data(), frame.size());
+    if (m_fds.empty())
+        return;
+
+    tap_vnet_hdr hdr{};
+    struct iovec iov[2];
+    int iovcnt = 0;
+
+    // header and frame go out with a single syscall, partial checksums are
+    // left for the host kernel to complete
+    if (m_vnet) {
+        if (frame.offload.needs_csum()) {
+            hdr.flags = eth_offload::NEEDS_CSUM;
+            hdr.csum_start = frame.offload.csum_start;
+            hdr.csum_offset = frame.offload.csum_offset;
+        }
+
+        iov[iovcnt++] = { &hdr, sizeof(hdr) };
+    }
+
+    iov[iovcnt++] = { (void*)frame.data(), frame.size() };
+
+    int fd = m_fds[select_queue(frame)];
+    ssize_t res;
+    do {
+        res = writev(fd, iov, iovcnt);
+    } while (res < 0 && errno == EINTR);
+
+    if (res < 0)
+        log_debug("dropping frame: %s", strerror(errno));
 }
 
 backend* backend_tap::create(bridge* br, const string& type) {
     unsigned int devno = 0;
-    if (sscanf(type.c_str(), "tap:%u", &devno) != 1)
+    unsigned int queues = 1;
+    if (sscanf(type.c_str(), "tap:%u:%u", &devno, &queues) < 1)
         devno = 0;
-    return new backend_tap(br, devno);
+    return new backend_tap(br, devno, queues);
 }
 
 } // namespace ethernet
@@ -23,14 +23,28 @@ namespace ethernet {
 class backend_tap : public backend
 {
 private:
-    int m_fd;
+    vector<int> m_fds;
+    vector<vector<u8>> m_buffers;
+    bool m_vnet;
+
+    atomic<bool> m_running;
+    thread m_thread;
+    int m_wakefd[2];
 
     void close_tap();
+    bool tap_read(size_t queue);
+    void tap_thread();
+
+    size_t select_queue(const eth_frame& frame) const;
 
 public:
-    backend_tap(bridge* br, int devno);
+    size_t queues() const { return m_fds.size(); }
+    bool has_vnet_hdr() const { return m_vnet; }
+
+    backend_tap(bridge* br, int devno, size_t queues = 1);
     virtual ~backend_tap();
 
+    virtual bool supports_offload() const override { return m_vnet; }
     virtual void send_to_host(const eth_frame& frame) override;
 
     static backend* create(bridge* br, const string& type);
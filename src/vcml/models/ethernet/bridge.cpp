@@ -66,14 +66,21 @@ void bridge::eth_receive(const eth_frame& frame) {
 
 void bridge::eth_transmit() {
     while (true) {
-        wait(m_ev);
+        if (m_rx.empty())
+            wait(m_rx_ev.event());
 
-        lock_guard<mutex> guard(m_mtx);
-        while (!m_rx.empty()) {
-            eth_frame frame = std::move(m_rx.front());
-            m_rx.pop();
-            eth_tx.send(frame);
-        }
+        // take a whole burst off the ring before delivering it, the ring
+        // keeps the buffers of the frames handed out in the previous burst
+        size_t n = 0;
+        while (n < m_rx_batch.size() && m_rx.exchange(m_rx_batch[n]))
+            n++;
+
+        for (size_t i = 0; i < n; i++)
+            eth_tx.send(m_rx_batch[i]);
+
+        // budget exhausted, let other processes run before the next burst
+        if (n == m_rx_batch.size())
+            wait(SC_ZERO_TIME);
     }
 }
 
@@ -88,13 +95,17 @@ bridge::bridge(const sc_module_name& nm):
     m_next_id(),
     m_dynamic_backends(),
     m_backends(),
-    m_mtx(),
+    m_fork_types(),
     m_rx(),
-    m_ev("rxev"),
+    m_rx_batch(),
+    m_rx_ev("rxev"),
     backends("backends", ""),
+    fork_backends("fork_backends", ""),
+    rx_budget("rx_budget", 32),
     eth_tx("eth_tx"),
     eth_rx("eth_rx") {
     bridges()[name()] = this;
+    m_rx_batch.resize(max<size_t>(rx_budget, 1));
 
     vector<string> types = split(backends);
     for (const string& type : types) {
@@ -125,15 +136,74 @@ bridge::~bridge() {
     bridges().erase(name());
 }
 
+void bridge::fork_prepare() {
+    m_fork_types.clear();
+    for (auto it : m_dynamic_backends) {
+        m_fork_types.push_back(it.second->type());
+        delete it.second;
+    }
+
+    m_dynamic_backends.clear();
+}
+
+void bridge::fork_child(size_t id) {
+    vector<string> types = m_fork_types;
+    if (!fork_backends.get().empty())
+        types = split(fork_expand(fork_backends, id));
+
+    for (const string& type : types) {
+        try {
+            create_backend(type);
+        } catch (std::exception& ex) {
+            log_warn("%s", ex.what());
+        }
+    }
+}
+
 void bridge::send_to_host(const eth_frame& frame) {
-    for (backend* b : m_backends)
-        b->send_to_host(frame);
+    optional<eth_frame> completed;
+    for (backend* b : m_backends) {
+        if (!frame.offload.needs_csum() || b->supports_offload()) {
+            b->send_to_host(frame);
+            continue;
+        }
+
+        if (!completed) {
+            completed = frame;
+            if (!completed->complete_checksum())
+                log_warn("invalid checksum offload: %s",
+                         frame.identify().c_str());
+        }
+
+        b->send_to_host(*completed);
+    }
 }
 
 void bridge::send_to_guest(eth_frame frame) {
-    lock_guard<mutex> guard(m_mtx);
-    m_rx.push(std::move(frame));
-    on_next_update([&]() -> void { m_ev.notify(SC_ZERO_TIME); });
+    if (!m_rx.push(std::move(frame))) {
+        log_debug("rx ring full, dropping frame");
+        return;
+    }
+
+    m_rx_ev.notify();
+}
+
+void bridge::send_to_guest(const u8* data, size_t len,
+                           const eth_offload& offload) {
+    VCML_ERROR_ON(len > eth_frame::FRAME_MAX_SIZE, "payload too big");
+    bool ok = m_rx.emplace([&](eth_frame& frame) -> void {
+        frame.assign(data, data + len);
+        if (frame.size() < eth_frame::FRAME_MIN_SIZE)
+            frame.resize(eth_frame::FRAME_MIN_SIZE, 0);
+        frame.offload = offload;
+    });
+
+    if (!ok) {
+        log_debug("rx ring full, dropping frame");
+        return;
+    }
+
+    m_rx_ev.notify();
 }
 
 void bridge::attach(backend* b) {
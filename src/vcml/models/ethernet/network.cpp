@@ -14,10 +14,12 @@ namespace vcml {
 namespace ethernet {
 
 void network::eth_receive(const eth_target_socket& rx, const eth_frame& fr) {
+    // forward a copy of the frame, so that its offload metadata is retained
+    eth_frame frame(fr);
     const eth_initiator_socket& sender = peer_of(rx);
     for (auto& tx : eth_tx) {
         if (tx.second != &sender)
-            tx.second->send(fr);
+            tx.second->send(frame);
     }
 }
 
@@ -103,6 +103,16 @@ void memory::reset() {
     load_images(images);
 }
 
+void memory::serialize(checkpoint& ckpt) {
+    peripheral::serialize(ckpt);
+    if (!ckpt.sparse("data", m_memory.data(), m_memory.size()))
+        log_warn("memory contents missing from checkpoint");
+
+    // make initiators drop anything they derived from the old contents
+    if (ckpt.is_restoring())
+        in.invalidate_dmi();
+}
+
 tlm_response_status memory::read(const range& addr, void* data,
                                  const tlm_sbi& info) {
     return m_memory.read(addr, data, info.is_debug);
@@ -34,11 +34,24 @@ bool lm75::cmd_set_temp(const vector<string>& args, ostream& os) {
     if (sscanf(args[0].c_str(), "%lf", &val) != 1)
         return false;
 
+    m_sensor.set(val);
     temp = to_temp9(val);
     log_info("setting temperature to %.1fC", from_temp9(temp));
     return true;
 }
 
+bool lm75::cmd_ramp_temp(const vector<string>& args, ostream& os) {
+    double val = 0.0, rate = 0.0;
+    if (sscanf(args[0].c_str(), "%lf", &val) != 1)
+        return false;
+    if (sscanf(args[1].c_str(), "%lf", &rate) != 1)
+        return false;
+
+    m_sensor.ramp(val, rate);
+    log_info("ramping temperature to %.1fC at %.2fC/s", val, rate);
+    return true;
+}
+
 bool lm75::cmd_set_high(const vector<string>& args, ostream& os) {
     double val = 0.0;
     if (sscanf(args[0].c_str(), "%lf", &val) != 1)
@@ -46,6 +59,7 @@ bool lm75::cmd_set_high(const vector<string>& args, ostream& os) {
 
     high = to_temp9(val);
     log_info("setting high temp threshold to %.1fC", from_temp9(high));
+    irq_update();
     return true;
 }
 
@@ -56,43 +70,51 @@ bool lm75::cmd_set_hyst(const vector<string>& args, ostream& os) {
 
     hyst = to_temp9(val);
     log_info("setting low temp threshold to %.1fC", from_temp9(hyst));
+    irq_update();
     return true;
 }
 
-void lm75::poll_temp() {
-    while (true) {
-        sc_time quantum = tlm_global_quantum::instance().get();
-        sc_time i2c_clk = sc_time(1.0 / (100 * kHz), SC_SEC);
-        wait(max(quantum, i2c_clk));
-        irq_update();
-    }
+void lm75::sample_temp() {
+    temp = to_temp9(m_sensor.value());
 }
 
 void lm75::irq_update() {
     if (config & CFG_SHUTDOWN) {
+        m_sensor.unwatch();
         alarm = false;
         return;
     }
 
+    sample_temp();
+
+    double t = from_temp9(temp);
+    double hi = from_temp9(high);
+    double lo = from_temp9(hyst);
+
     if (config & CFG_INT) { // interrupt mode
-        if (!m_evt && temp > high) {
+        if (!m_evt && t > hi) {
             m_evt = true;
             alarm = true;
-        } else if (m_evt && temp < hyst) {
+        } else if (m_evt && t < lo) {
             m_evt = false;
             alarm = true;
         }
     } else { // comparator mode
-        if (temp > high)
+        if (t > hi)
             alarm = true;
-        if (temp < hyst)
+        if (t < lo)
             alarm = false;
     }
+
+    // the register value is truncated towards zero, so depending on the
+    // sign the comparisons flip up to half a degree past the thresholds
+    m_sensor.watch({ hi, hi + 0.5, lo - 0.5, lo });
 }
 
 void lm75::load_buffer() {
     switch (pointer & 3) {
     case REG_TEMP:
+        sample_temp();
         log_debug("reading temp 0x%hx (%.1lfC)", temp.get(), from_temp9(temp));
         m_buf[0] = temp >> 1;
         m_buf[1] = temp << 7;
@@ -152,6 +174,7 @@ lm75::lm75(const sc_module_name& nm, u8 address):
     m_buf(),
     m_len(),
     m_evt(false),
+    m_sensor("sensor"),
     pointer("pointer", 0),
     config("config", 0),
     temp("temp", to_temp9(22.5)),
@@ -161,15 +184,20 @@ lm75::lm75(const sc_module_name& nm, u8 address):
     i2c("i2c"),
     alarm("alarm") {
     i2c.set_address(i2c_addr);
+    m_sensor.set(from_temp9(temp));
     register_command("set_temp", 1, &lm75::cmd_set_temp,
                      "sets the temperature reported by the sensor in C");
+    register_command("ramp_temp", 2, &lm75::cmd_ramp_temp,
+                     "changes the temperature linearly over time, usage: "
+                     "ramp_temp <target in C> <rate in C/s>");
     register_command("set_temp_hi", 1, &lm75::cmd_set_high,
                      "sets the temperature threshold for the alarm signal");
     register_command("set_temp_lo", 1, &lm75::cmd_set_hyst,
                      "sets the temperature threshold for clearing alarm");
 
     SC_HAS_PROCESS(lm75);
-    SC_THREAD(poll_temp);
+    SC_METHOD(irq_update);
+    sensitive << m_sensor.event();
 }
 
 void lm75::reset() {
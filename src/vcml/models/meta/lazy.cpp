@@ -0,0 +1,218 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/meta/lazy.h"
+
+namespace vcml {
+namespace meta {
+
+static bool parse_port(const string& port, string& name, size_t& idx) {
+    size_t open = port.find('[');
+    if (open == string::npos || port.back() != ']') {
+        name = port;
+        return false;
+    }
+
+    name = port.substr(0, open);
+    idx = from_string<size_t>(port.substr(open + 1, port.size() - open - 2));
+    return true;
+}
+
+std::set<string>& lazy::usage_list(const string& file) {
+    static std::map<string, std::set<string>> lists;
+    auto it = lists.find(file);
+    if (it != lists.end())
+        return it->second;
+
+    std::set<string>& names = lists[file];
+    std::ifstream stream(file);
+    string line;
+    while (std::getline(stream, line)) {
+        line = trim(line);
+        if (!line.empty())
+            names.insert(line);
+    }
+
+    return names;
+}
+
+bool lazy::needs_model() {
+    if (wrapped.get().empty())
+        return false;
+
+    if (build == "always")
+        return true;
+    if (build == "never")
+        return false;
+
+    if (build != "used")
+        log_warn("unknown build mode '%s'", build.c_str());
+
+    // without a record of earlier runs, build everything and start one
+    if (usage.get().empty() || !mwr::file_exists(usage))
+        return true;
+
+    return stl_contains(usage_list(usage), string(name()));
+}
+
+void lazy::bind_model(module& mod) {
+    out.bind(tlm_target(mod, target_port));
+
+    if (mod.find_child("clk"))
+        m_clk.bind(clk_target(mod, "clk"));
+    else
+        m_clk.stub();
+
+    if (mod.find_child("rst"))
+        m_rst.bind(gpio_target(mod, "rst"));
+    else
+        m_rst.stub();
+
+    size_t i = 0;
+    for (const string& port : irq_ports) {
+        string nm;
+        size_t idx = 0;
+        if (parse_port(port, nm, idx))
+            gpio_initiator(mod, nm, idx).bind(m_irq[i++]);
+        else
+            gpio_initiator(mod, nm).bind(m_irq[i++]);
+    }
+}
+
+void lazy::report_usage() {
+    if (m_reported)
+        return;
+
+    m_reported = true;
+    if (!is_built()) {
+        // the guest would only see bus errors from here on, stop instead
+        // so that the next run can build the model from the usage file
+        if (usage.get().empty()) {
+            log_error("%s accessed but not built", wrapped.c_str());
+        } else {
+            log_error("%s accessed but not built, usage file '%s' updated, "
+                      "simulation must be repeated",
+                      wrapped.c_str(), usage.c_str());
+        }
+
+        request_stop();
+    }
+
+    if (usage.get().empty())
+        return;
+
+    std::set<string>& names = usage_list(usage);
+    if (!names.insert(name()).second)
+        return;
+
+    std::ofstream stream(usage.get(), std::ios::app);
+    if (!stream.good()) {
+        log_warn("cannot write usage file '%s'", usage.c_str());
+        return;
+    }
+
+    stream << name() << std::endl;
+}
+
+void lazy::b_transport(tlm_target_socket& origin, tlm_generic_payload& tx,
+                       sc_time& dt) {
+    report_usage();
+
+    if (m_model)
+        out.b_transport(tx, dt);
+    else
+        tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+}
+
+unsigned int lazy::transport_dbg(tlm_target_socket& origin,
+                                 tlm_generic_payload& tx) {
+    if (m_model)
+        return out->transport_dbg(tx);
+
+    tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+    return 0;
+}
+
+bool lazy::get_direct_mem_ptr(tlm_target_socket& origin,
+                              tlm_generic_payload& tx, tlm_dmi& dmi) {
+    return m_model && out->get_direct_mem_ptr(tx, dmi);
+}
+
+void lazy::invalidate_direct_mem_ptr(tlm_initiator_socket& origin, u64 start,
+                                     u64 end) {
+    in->invalidate_direct_mem_ptr(start, end);
+}
+
+void lazy::gpio_transport(const gpio_target_socket& socket,
+                          gpio_payload& tx) {
+    if (m_model && socket == rst)
+        m_rst = tx.state;
+    component::gpio_transport(socket, tx);
+}
+
+void lazy::gpio_notify(const gpio_target_socket& socket, bool state,
+                       gpio_vector vector) {
+    if (m_irq.contains(socket))
+        irq[m_irq.index_of(socket)].write(state, vector);
+}
+
+module* lazy::wrapped_model() const {
+    if (m_model == nullptr)
+        return nullptr;
+    module& mod = *m_model;
+    return &mod;
+}
+
+lazy::lazy(const sc_module_name& nm, const string& kind):
+    component(nm),
+    m_model(nullptr),
+    m_reported(false),
+    m_clk("clk_out"),
+    m_rst("rst_out"),
+    m_irq("irq_in"),
+    wrapped("wrapped", kind),
+    build("build", "used"),
+    usage("usage", ""),
+    target_port("target_port", "in"),
+    irq_ports("irq_ports"),
+    in("in"),
+    out("out"),
+    irq("irq") {
+    if (!needs_model()) {
+        out.stub();
+        m_clk.stub();
+        m_rst.stub();
+        log_debug("deferring %s", wrapped.c_str());
+        return;
+    }
+
+    m_model = new vcml::model("model", wrapped);
+    bind_model(*m_model);
+}
+
+lazy::~lazy() {
+    if (m_model)
+        delete m_model;
+}
+
+void lazy::handle_clock_update(hz_t oldclk, hz_t newclk) {
+    if (m_model)
+        m_clk = newclk;
+}
+
+VCML_EXPORT_MODEL(vcml::meta::lazy, name, args) {
+    string kind;
+    for (const string& arg : args)
+        kind += kind.empty() ? arg : " " + arg;
+    return new lazy(name, kind);
+}
+
+} // namespace meta
+} // namespace vcml
@@ -0,0 +1,502 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/meta/shmbridge.h"
+
+namespace vcml {
+namespace meta {
+
+static_assert(atomic<u64>::is_always_lock_free,
+              "shared memory channels require lock-free 64bit atomics");
+
+// Single producer single consumer ring, the producer only writes head and
+// the consumer only writes tail, so it works across process boundaries.
+template <size_t N>
+struct shm_ring {
+    alignas(64) atomic<u64> head;
+    alignas(64) atomic<u64> tail;
+    shmbridge::message slots[N];
+
+    bool push(const shmbridge::message& msg) {
+        u64 h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N)
+            return false;
+
+        slots[h % N] = msg;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(shmbridge::message& msg) {
+        u64 t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        msg = slots[t % N];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+enum shm_state : u64 {
+    SHM_UNATTACHED = 0,
+    SHM_ATTACHED = 1,
+    SHM_DETACHED = 2,
+};
+
+// freshly created shared memory is zero-filled, which is a valid initial
+// state for all members, so no further handshake is needed
+struct shm_channel {
+    atomic<u64> state[2];
+    atomic<u64> pid[2];
+    atomic<u64> time[2];
+    shm_ring<64> rings[2];
+};
+
+static string shm_name(const string& channel) {
+    return starts_with(channel, "/") ? channel : "/" + channel;
+}
+
+vector<shmbridge*>& shmbridge::bridges() {
+    static vector<shmbridge*> instances;
+    return instances;
+}
+
+void shmbridge::sync_thread() {
+    const size_t peer = 1 - m_side;
+    while (true) {
+        sc_time interval = sync_interval;
+        if (interval == SC_ZERO_TIME)
+            interval = tlm::tlm_global_quantum::instance().get();
+        VCML_ERROR_ON(interval == SC_ZERO_TIME, "sync interval is zero");
+
+        wait(interval);
+
+        u64 now = sc_time_stamp().value();
+        m_chan->time[m_side] = now;
+        service_all();
+
+        // a peer in the same process is driven by our own kernel already
+        if (m_chan->pid[peer] == (u64)mwr::getpid())
+            continue;
+
+        while (m_chan->time[peer] < now && !peer_detached() && sim_running()) {
+            service_all();
+            mwr::cpu_yield();
+        }
+    }
+}
+
+void shmbridge::gpio_update() {
+    vector<message> pending;
+    std::swap(pending, m_gpio_pending);
+    for (const message& msg : pending) {
+        if (gpio_out.exists(msg.index))
+            gpio_out[msg.index].write(msg.status != 0, msg.vector);
+        else
+            log_warn("gpio_out[%u] not connected", msg.index);
+    }
+}
+
+bool shmbridge::peer_detached() const {
+    return m_chan->state[1 - m_side] == SHM_DETACHED;
+}
+
+bool shmbridge::post(message& msg) {
+    shm_ring<64>& ring = m_chan->rings[m_side];
+    while (!ring.push(msg)) {
+        if (peer_detached() || !sim_running())
+            return false;
+        service_all();
+        mwr::cpu_yield();
+    }
+
+    return true;
+}
+
+bool shmbridge::request(message& req, message& rsp) {
+    req.id = m_next_id++;
+    if (!post(req))
+        return false;
+
+    // keep serving incoming requests of all bridges in this process while
+    // waiting, otherwise two processes waiting for each other would lock up
+    auto it = m_responses.find(req.id);
+    while (it == m_responses.end()) {
+        if (peer_detached() || !sim_running())
+            return false;
+
+        service_all();
+        mwr::cpu_yield();
+        it = m_responses.find(req.id);
+    }
+
+    rsp = it->second;
+    m_responses.erase(it);
+    return true;
+}
+
+void shmbridge::service() {
+    message msg;
+    shm_ring<64>& ring = m_chan->rings[1 - m_side];
+    while (ring.pop(msg))
+        handle_message(msg);
+}
+
+void shmbridge::handle_message(message& msg) {
+    switch (msg.type) {
+    case MSG_RESPONSE:
+        m_responses[msg.id] = msg;
+        break;
+
+    case MSG_GPIO:
+        m_gpio_pending.push_back(msg);
+        m_gpio_ev.notify(SC_ZERO_TIME);
+        break;
+
+    default:
+        log_warn("unexpected message type %u", msg.type);
+        break;
+    }
+}
+
+void shmbridge::gpio_notify(const gpio_target_socket& socket, bool state,
+                            gpio_vector vector) {
+    message msg{};
+    msg.type = MSG_GPIO;
+    msg.index = gpio_in.index_of(socket);
+    msg.status = state ? 1 : 0;
+    msg.vector = vector;
+    if (!post(msg))
+        log_warn("dropped gpio_in[%u] update", msg.index);
+}
+
+void shmbridge::end_of_simulation() {
+    component::end_of_simulation();
+    detach();
+}
+
+bool shmbridge::is_connected() const {
+    return m_chan->state[1 - m_side] == SHM_ATTACHED;
+}
+
+shmbridge::shmbridge(const sc_module_name& nm, size_t side):
+    component(nm),
+    m_shm(),
+    m_chan(nullptr),
+    m_side(side),
+    m_next_id(0),
+    m_responses(),
+    m_gpio_pending(),
+    m_gpio_ev("gpio_ev"),
+    channel("channel", "vcml_shmbridge"),
+    sync_interval("sync_interval", SC_ZERO_TIME),
+    gpio_in("gpio_in"),
+    gpio_out("gpio_out") {
+    VCML_ERROR_ON(side > SIDE_INITIATOR, "invalid bridge side: %zu", side);
+
+    m_shm.init(shm_name(channel), sizeof(shm_channel), VCML_ALIGN_4K);
+    m_chan = (shm_channel*)m_shm.data();
+
+    u64 state = m_chan->state[m_side].exchange(SHM_ATTACHED);
+    if (state == SHM_ATTACHED)
+        VCML_ERROR("channel %s already has a %s side", channel.c_str(),
+                   m_side == SIDE_TARGET ? "target" : "initiator");
+
+    m_chan->pid[m_side] = mwr::getpid();
+    m_chan->time[m_side] = 0;
+
+    bridges().push_back(this);
+
+    SC_HAS_PROCESS(shmbridge);
+    SC_THREAD(sync_thread);
+
+    SC_METHOD(gpio_update);
+    sensitive << m_gpio_ev;
+    dont_initialize();
+}
+
+shmbridge::~shmbridge() {
+    detach();
+    stl_remove(bridges(), this);
+}
+
+void shmbridge::detach() {
+    if (m_chan == nullptr || m_chan->state[m_side] == SHM_DETACHED)
+        return;
+
+    // never hold up the peer after we are gone
+    m_chan->time[m_side] = ~0ull;
+    m_chan->state[m_side] = SHM_DETACHED;
+}
+
+void shmbridge::service_all(const shmbridge* except) {
+    for (shmbridge* bridge : bridges())
+        if (bridge != except)
+            bridge->service();
+}
+
+u8* shmbridge_target::map_shared(const string& name, size_t offset,
+                                 size_t extent) {
+    // the segment is owned by the peer, so only attach to it here instead
+    // of creating it or unlinking it once we are done
+    auto it = m_mappings.find(name);
+    if (it == m_mappings.end()) {
+        it = m_mappings
+                 .emplace(std::piecewise_construct, std::forward_as_tuple(name),
+                          std::forward_as_tuple())
+                 .first;
+        try {
+            it->second.attach(name, extent);
+        } catch (...) {
+            m_mappings.erase(it);
+            throw;
+        }
+    }
+
+    VCML_ERROR_ON(offset >= it->second.size(), "invalid offset into %s",
+                  name.c_str());
+    return it->second.data() + offset;
+}
+
+void shmbridge_target::forward(tlm_generic_payload& tx, sc_time& dt,
+                               bool debug) {
+    if (tx.get_byte_enable_ptr() != nullptr) {
+        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return;
+    }
+
+    if (tx.get_streaming_width() < tx.get_data_length()) {
+        tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
+        return;
+    }
+
+    u8* ptr = tx.get_data_ptr();
+    u64 addr = tx.get_address();
+    u64 size = tx.get_data_length();
+    bool dmi = true;
+
+    // transactions larger than a message are split up, which is fine for
+    // memory but may be observed by peripherals with side effects
+    tlm_response_status rs = TLM_OK_RESPONSE;
+    for (u64 off = 0; off < size && success(rs);) {
+        message req{};
+        req.type = debug ? MSG_DEBUG : MSG_TRANSPORT;
+        req.status = (i32)tx.get_command();
+        req.addr = addr + off;
+        req.size = min<u64>(size - off, MESSAGE_DATA_SIZE);
+        if (tx.is_write())
+            memcpy(req.data, ptr + off, req.size);
+
+        message rsp{};
+        if (!request(req, rsp)) {
+            log_warn("peer detached from channel %s", channel.c_str());
+            rs = TLM_GENERIC_ERROR_RESPONSE;
+            break;
+        }
+
+        rs = (tlm_response_status)rsp.status;
+        if (success(rs) && tx.is_read())
+            memcpy(ptr + off, rsp.data, req.size);
+
+        dmi &= (rsp.flags & FLAG_DMI_ALLOWED) != 0;
+        dt += time_from_value(rsp.time);
+        off += req.size;
+    }
+
+    tx.set_dmi_allowed(dmi && success(rs) && allow_dmi);
+    tx.set_response_status(rs);
+}
+
+void shmbridge_target::handle_message(message& msg) {
+    switch (msg.type) {
+    case MSG_INVALIDATE:
+        in->invalidate_direct_mem_ptr(msg.addr, msg.addr + msg.size - 1);
+        break;
+
+    default:
+        shmbridge::handle_message(msg);
+        break;
+    }
+}
+
+void shmbridge_target::b_transport(tlm_target_socket& origin,
+                                   tlm_generic_payload& tx, sc_time& dt) {
+    forward(tx, dt, false);
+}
+
+unsigned int shmbridge_target::transport_dbg(tlm_target_socket& origin,
+                                             tlm_generic_payload& tx) {
+    sc_time dt = SC_ZERO_TIME;
+    forward(tx, dt, true);
+    return tx.is_response_ok() ? tx.get_data_length() : 0;
+}
+
+bool shmbridge_target::get_direct_mem_ptr(tlm_target_socket& origin,
+                                          tlm_generic_payload& tx,
+                                          tlm_dmi& dmi) {
+    if (!allow_dmi)
+        return false;
+
+    message req{};
+    req.type = MSG_DMI;
+    req.status = (i32)tx.get_command();
+    req.addr = tx.get_address();
+
+    message rsp{};
+    if (!request(req, rsp) || rsp.status == VCML_ACCESS_NONE)
+        return false;
+
+    // only memory that lives in shared memory on the other side can be
+    // accessed directly from here, the peer rejects everything else
+    string name((const char*)rsp.data);
+    try {
+        dmi.set_dmi_ptr(map_shared(name, rsp.offset, rsp.extent));
+    } catch (std::exception& ex) {
+        log_warn("cannot map %s: %s", name.c_str(), ex.what());
+        return false;
+    }
+
+    dmi.set_start_address(rsp.addr);
+    dmi.set_end_address(rsp.addr + rsp.size - 1);
+    dmi.set_read_latency(SC_ZERO_TIME);
+    dmi.set_write_latency(SC_ZERO_TIME);
+
+    switch (rsp.status) {
+    case VCML_ACCESS_READ:
+        dmi.allow_read();
+        break;
+    case VCML_ACCESS_WRITE:
+        dmi.allow_write();
+        break;
+    default:
+        dmi.allow_read_write();
+        break;
+    }
+
+    return true;
+}
+
+shmbridge_target::shmbridge_target(const sc_module_name& nm):
+    shmbridge(nm, SIDE_TARGET), m_mappings(), in("in") {
+    // nothing to do
+}
+
+void shmbridge_initiator::handle_transport(message& msg) {
+    tlm_sbi info = msg.type == MSG_DEBUG ? SBI_DEBUG : SBI_NONE;
+    tlm_command cmd = (tlm_command)msg.status;
+    unsigned int size = (unsigned int)msg.size;
+
+    message rsp{};
+    rsp.type = MSG_RESPONSE;
+    rsp.id = msg.id;
+
+    // report the time the access took back to the requester, which adds it
+    // to its own quantum offset, so it must not be accounted for here again
+    sc_time& local = local_time();
+    const sc_time prev = local;
+    const sc_time start = local_time_stamp();
+    rsp.status = (i32)out.access(cmd, msg.addr, msg.data, size, info);
+    rsp.time = (local_time_stamp() - start).value();
+    if (local > prev)
+        local = prev;
+
+    if (cmd == TLM_READ_COMMAND)
+        memcpy(rsp.data, msg.data, size);
+
+    // only memory that the peer can map itself is worth a dmi request
+    size_t offset = 0;
+    u8* ptr = out.lookup_dmi_ptr(msg.addr, size, VCML_ACCESS_READ);
+    if (ptr && tlm_memory::find_shared(ptr, offset))
+        rsp.flags |= FLAG_DMI_ALLOWED;
+
+    if (!post(rsp))
+        log_warn("dropped response to request %llu", msg.id);
+}
+
+void shmbridge_initiator::handle_dmi(message& msg) {
+    message rsp{};
+    rsp.type = MSG_RESPONSE;
+    rsp.id = msg.id;
+    rsp.status = VCML_ACCESS_NONE;
+
+    tlm_dmi dmi;
+    tlm_generic_payload tx;
+    tx.set_command((tlm_command)msg.status);
+    tx.set_address(msg.addr);
+
+    size_t offset = 0;
+    const tlm_memory* mem = nullptr;
+    if (out->get_direct_mem_ptr(tx, dmi))
+        mem = tlm_memory::find_shared(dmi.get_dmi_ptr(), offset);
+
+    if (mem != nullptr && strlen(mem->shared_name()) < MESSAGE_DATA_SIZE) {
+        out.map_dmi(dmi);
+
+        rsp.addr = dmi.get_start_address();
+        rsp.size = dmi.get_end_address() - dmi.get_start_address() + 1;
+        rsp.offset = offset;
+        rsp.extent = mem->shared_size();
+        strcpy((char*)rsp.data, mem->shared_name());
+
+        if (dmi.is_read_write_allowed())
+            rsp.status = VCML_ACCESS_READ_WRITE;
+        else if (dmi.is_write_allowed())
+            rsp.status = VCML_ACCESS_WRITE;
+        else
+            rsp.status = VCML_ACCESS_READ;
+    }
+
+    if (!post(rsp))
+        log_warn("dropped response to request %llu", msg.id);
+}
+
+void shmbridge_initiator::handle_message(message& msg) {
+    switch (msg.type) {
+    case MSG_TRANSPORT:
+    case MSG_DEBUG:
+        handle_transport(msg);
+        break;
+
+    case MSG_DMI:
+        handle_dmi(msg);
+        break;
+
+    default:
+        shmbridge::handle_message(msg);
+        break;
+    }
+}
+
+void shmbridge_initiator::invalidate_direct_mem_ptr(
+    tlm_initiator_socket& origin, u64 start, u64 end) {
+    message msg{};
+    msg.type = MSG_INVALIDATE;
+    msg.addr = start;
+    msg.size = end - start + 1;
+    if (!post(msg))
+        log_warn("dropped dmi invalidation 0x%016llx..0x%016llx", start, end);
+}
+
+shmbridge_initiator::shmbridge_initiator(const sc_module_name& nm):
+    shmbridge(nm, SIDE_INITIATOR), out("out") {
+    // nothing to do
+}
+
+VCML_EXPORT_MODEL(vcml::meta::shmbridge_target, name, args) {
+    return new shmbridge_target(name);
+}
+
+VCML_EXPORT_MODEL(vcml::meta::shmbridge_initiator, name, args) {
+    return new shmbridge_initiator(name);
+}
+
+} // namespace meta
+} // namespace vcml
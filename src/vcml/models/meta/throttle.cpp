@@ -10,9 +10,40 @@
 
 #include "vcml/models/meta/throttle.h"
 
+#ifdef MWR_LINUX
+#include <errno.h>
+#include <time.h>
+#endif
+
 namespace vcml {
 namespace meta {
 
+static u64 host_time_ns() {
+#ifdef MWR_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+#else
+    return mwr::timestamp_us() * 1000ull;
+#endif
+}
+
+static void sleep_until_ns(u64 deadline) {
+#ifdef MWR_LINUX
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000ull;
+    ts.tv_nsec = deadline % 1000000000ull;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+           EINTR) {
+        // retry until the deadline has passed
+    }
+#else
+    u64 now = host_time_ns();
+    if (deadline > now)
+        mwr::usleep((deadline - now) / 1000);
+#endif
+}
+
 static u64 do_usleep(u64 delta) {
     u64 start = mwr::timestamp_us();
     mwr::usleep(delta);
@@ -28,6 +59,13 @@ void throttle::update() {
     sc_time interval = max<sc_time>(quantum, update_interval);
     next_trigger(interval);
 
+    if (m_deadline)
+        update_deadline_mode();
+    else
+        update_interval_mode(interval);
+}
+
+void throttle::update_interval_mode(const sc_time& interval) {
     if (rtf > 0.0) {
         u64 actual = mwr::timestamp_us() - m_start + m_extra;
         u64 target = time_to_us(interval) / rtf;
@@ -48,23 +86,72 @@ void throttle::update() {
     m_start = mwr::timestamp_us();
 }
 
+void throttle::update_deadline_mode() {
+    u64 now = host_time_ns();
+    sc_time t = sc_time_stamp();
+
+    // re-anchor whenever the target factor changes
+    if (rtf <= 0.0 || rtf != m_rtf) {
+        m_rtf = rtf;
+        m_origin = now;
+        m_origin_sim = t;
+        m_throttling = false;
+        return;
+    }
+
+    // host time at which the current simulation time should be reached,
+    // sleeping to an absolute deadline makes oversleeping self-correcting
+    u64 elapsed = time_to_ns(t - m_origin_sim);
+    u64 deadline = m_origin + (u64)((double)elapsed / rtf);
+
+    if (deadline > now) {
+        if (!m_throttling)
+            log_debug("throttling started");
+        m_throttling = true;
+        sleep_until_ns(deadline);
+        return;
+    }
+
+    if (m_throttling)
+        log_debug("throttling stopped");
+    m_throttling = false;
+
+    // proportional correction: forgive part of the lag, so the simulation
+    // catches up smoothly instead of running unthrottled in bursts
+    double k = std::clamp<double>(gain, 0.0, 1.0);
+    m_origin += (u64)((now - deadline) * k);
+}
+
 throttle::throttle(const sc_module_name& nm):
     module(nm),
     m_throttling(false),
     m_start(mwr::timestamp_us()),
     m_extra(0),
+    m_deadline(true),
+    m_rtf(0.0),
+    m_origin(host_time_ns()),
+    m_origin_sim(SC_ZERO_TIME),
     update_interval("update_interval", sc_time(10.0, SC_MS)),
-    rtf("rtf", 0.0) {
+    rtf("rtf", 0.0),
+    mode("mode", "deadline"),
+    gain("gain", 0.1) {
+    if (mode == "interval")
+        m_deadline = false;
+    else if (mode != "deadline")
+        VCML_ERROR("unknown throttle mode: %s", mode.c_str());
+
     SC_HAS_PROCESS(throttle);
     SC_METHOD(update);
 }
 
 void throttle::session_suspend() {
     m_start -= mwr::timestamp_us();
+    m_origin -= host_time_ns();
 }
 
 void throttle::session_resume() {
     m_start += mwr::timestamp_us();
+    m_origin += host_time_ns();
     m_extra = 0;
 }
 
@@ -35,9 +35,6 @@ void ockbd::update() {
         log_debug("setting IRQ");
 
     irq = !m_key_fifo.empty();
-
-    sc_time quantum = tlm_global_quantum::instance().get();
-    next_trigger(max(clock_cycle(), quantum));
 }
 
 u8 ockbd::read_khr() {
@@ -65,6 +62,7 @@ ockbd::ockbd(const sc_module_name& nm):
     m_key_fifo(),
     m_keyboard(name()),
     m_console(),
+    m_input_ev("input_ev"),
     khr("khr", 0x0, 0),
     irq("irq"),
     in("in"),
@@ -77,8 +75,12 @@ ockbd::ockbd(const sc_module_name& nm):
 
     if (m_console.has_display()) {
         m_console.notify(m_keyboard);
+        m_keyboard.on_event([this]() -> void { m_input_ev.notify(); });
+
         SC_HAS_PROCESS(ockbd);
         SC_METHOD(update);
+        sensitive << m_input_ev.event();
+        dont_initialize();
     }
 }
 
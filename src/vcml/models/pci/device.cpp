@@ -80,10 +80,14 @@ cap_msi::cap_msi(const string& nm, u16 control):
 }
 
 void cap_msix::set_masked(unsigned int vector, bool set) {
-    if (set)
+    const u32 mask = 1u << (vector % 32);
+    if (set) {
         msix_table[vector].ctrl |= PCI_MSIX_MASKED;
-    else
+        msix_mask[vector / 32] |= mask;
+    } else {
         msix_table[vector].ctrl &= ~PCI_MSIX_MASKED;
+        msix_mask[vector / 32] &= ~mask;
+    }
 }
 
 void cap_msix::set_pending(unsigned int vector, bool set) {
@@ -92,6 +96,11 @@ void cap_msix::set_pending(unsigned int vector, bool set) {
         msix_pba[vector / 32] |= mask;
     else
         msix_pba[vector / 32] &= ~mask;
+
+    if (msix_pba[vector / 32])
+        msix_pending_words |= 1ull << (vector / 32);
+    else
+        msix_pending_words &= ~(1ull << (vector / 32));
 }
 
 cap_msix::cap_msix(const string& nm, u32 bar_idx, size_t nvec, u32 off):
@@ -102,6 +111,8 @@ cap_msix::cap_msix(const string& nm, u32 bar_idx, size_t nvec, u32 off):
     num_vectors(nvec),
     msix_table(),
     msix_pba(),
+    msix_mask(),
+    msix_pending_words(),
     msix_control(),
     msix_bir_off() {
     VCML_ERROR_ON(bar < 0 || bar > PCI_NUM_BARS, "invalid BAR specified");
@@ -125,11 +136,14 @@ cap_msix::cap_msix(const string& nm, u32 bar_idx, size_t nvec, u32 off):
 
     msix_table = new msix_entry[nvec];
     msix_pba = new u32[(nvec + 31) / 32];
+    msix_mask = new u32[(nvec + 31) / 32];
 
     msix_control = new_cap_reg_rw<u16>("msix_control", control);
     msix_control->on_write(&device::write_msix_ctrl);
     msix_bir_off = new_cap_reg_ro<u32>("msix_bir_off", tbl_off);
     msix_pba_off = new_cap_reg_ro<u32>("msix_pba_off", pba_off);
+
+    reset();
 }
 
 cap_msix::~cap_msix() {
@@ -137,6 +151,8 @@ cap_msix::~cap_msix() {
         delete[] msix_table;
     if (msix_pba)
         delete[] msix_pba;
+    if (msix_mask)
+        delete[] msix_mask;
 }
 
 void cap_msix::reset() {
@@ -147,6 +163,8 @@ void cap_msix::reset() {
     }
 
     memset(msix_pba, 0, sizeof(u32) * ((num_vectors + 31) / 32));
+    memset(msix_mask, 0xff, sizeof(u32) * ((num_vectors + 31) / 32));
+    msix_pending_words = 0;
 }
 
 tlm_response_status cap_msix::read_table(const range& addr, void* data) {
@@ -175,6 +193,7 @@ tlm_response_status cap_msix::write_table(const range& addr,
     memcpy((u8*)(entry) + offset, data, addr.length());
     entry->addr &= ~3ull;
     entry->ctrl &= PCI_MSIX_MASKED;
+    set_masked(vector, entry->ctrl & PCI_MSIX_MASKED);
     dev->m_msix_notify.notify(SC_ZERO_TIME);
     return TLM_OK_RESPONSE;
 }
@@ -209,7 +228,8 @@ device::device(const sc_module_name& nm, const pci_config& cfg):
     m_msi(nullptr),
     m_msix(nullptr),
     m_msi_notify("msi_notify"),
-    m_msix_notify("msix_notify") {
+    m_msix_notify("msix_notify"),
+    m_msix_batch() {
     pci_vendor_id.allow_read_only();
     pci_vendor_id.sync_never();
 
@@ -408,11 +428,10 @@ void device::msi_send(unsigned int vector) {
 void device::msi_process() {
     while (true) {
         wait(m_msi_notify);
-        for (unsigned int vec = 0; vec < m_msi->num_vectors(); vec++) {
-            if (m_msi->is_pending(vec) && !m_msi->is_masked(vec)) {
-                m_msi->set_pending(vec, false);
-                msi_send(vec);
-            }
+        for (u32 bits = m_msi->deliverable(); bits; bits &= bits - 1) {
+            unsigned int vec = ctz(bits);
+            m_msi->set_pending(vec, false);
+            msi_send(vec);
         }
     }
 }
@@ -428,15 +447,38 @@ void device::msix_send(unsigned int vector) {
         log_warn("DMA error while sending MSIX%u", vector);
 }
 
+void device::msix_send(const vector<unsigned int>& vectors) {
+    for (unsigned int vec : vectors) {
+        // the guest may have masked the vector while we were blocked sending
+        // earlier ones, so keep it pending until it gets unmasked again
+        if (m_msix->is_masked(vec))
+            m_msix->set_pending(vec, true);
+        else
+            msix_send(vec);
+    }
+}
+
 void device::msix_process() {
     while (true) {
         wait(m_msix_notify);
-        for (unsigned int vec = 0; vec < m_msix->num_vectors; vec++) {
-            if (m_msix->is_pending(vec) && !m_msix->is_masked(vec)) {
+        if (*m_msix->msix_control & PCI_MSIX_ALL_MASKED)
+            continue;
+
+        // collect everything deliverable first, the table may change while
+        // we are blocked sending individual messages
+        m_msix_batch.clear();
+        u64 words = m_msix->msix_pending_words;
+        for (; words; words &= words - 1) {
+            unsigned int word = ctz(words);
+            u32 bits = m_msix->msix_pba[word] & ~m_msix->msix_mask[word];
+            for (; bits; bits &= bits - 1) {
+                unsigned int vec = word * 32 + ctz(bits);
                 m_msix->set_pending(vec, false);
-                msix_send(vec);
+                m_msix_batch.push_back(vec);
             }
         }
+
+        msix_send(m_msix_batch);
     }
 }
 
@@ -13,8 +13,8 @@
 namespace vcml {
 namespace riscv {
 
-u64 clint::get_cycles() const {
-    sc_time delta = sc_time_stamp() - m_time_reset;
+u64 clint::get_cycles(const sc_time& t) const {
+    sc_time delta = t - m_time_reset;
     return delta / clock_cycle();
 }
 
@@ -46,12 +46,12 @@ void clint::write_mtimecmp(u64 val, size_t hart) {
     update_timer();
 }
 
-u64 clint::read_mtime() {
-    return get_cycles();
+u64 clint::read_mtime(const sc_time& t) {
+    return get_cycles(t);
 }
 
 void clint::update_timer() {
-    u64 mtime = get_cycles();
+    u64 mtime = get_cycles(sc_time_stamp());
 
     for (auto it : irq_timer) {
         auto hart = it.first;
@@ -86,7 +86,7 @@ clint::clint(const sc_module_name& nm):
     mtimecmp.allow_read_write();
     mtimecmp.on_write(&clint::write_mtimecmp);
 
-    mtime.sync_on_read();
+    mtime.sync_never();
     mtime.allow_read_only();
     mtime.on_read(&clint::read_mtime);
 
@@ -148,8 +148,10 @@ terminal::terminal(const sc_module_name& nm):
     m_next_id(),
     m_backends(),
     m_listeners(),
+    m_fork_types(),
     m_async_ev("async_ev"),
     backends("backends", ""),
+    fork_backends("fork_backends", ""),
     config("config", "9600N8"),
     untimed("untimed", false),
     serial_tx("serial_tx"),
@@ -202,6 +204,30 @@ terminal::~terminal() {
     terminals().erase(name());
 }
 
+void terminal::fork_prepare() {
+    m_fork_types.clear();
+    for (auto it : m_backends) {
+        m_fork_types.push_back(it.second->type());
+        delete it.second;
+    }
+
+    m_backends.clear();
+}
+
+void terminal::fork_child(size_t id) {
+    vector<string> types = m_fork_types;
+    if (!fork_backends.get().empty())
+        types = split(fork_expand(fork_backends, id));
+
+    for (const auto& type : types) {
+        try {
+            create_backend(type);
+        } catch (std::exception& ex) {
+            log_warn("%s", ex.what());
+        }
+    }
+}
+
 void terminal::attach(backend* b) {
     if (stl_contains(m_listeners, b))
         VCML_ERROR("attempt to attach backend twice");
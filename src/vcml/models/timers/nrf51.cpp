@@ -35,17 +35,17 @@ u32 nrf51::counter_mask() const {
     return masks[bitmode & 3];
 }
 
-u32 nrf51::current_count() const {
+u32 nrf51::current_count(const sc_time& t) const {
     if (!m_running || is_counter_mode())
         return count;
 
-    u32 ticks = time_to_ticks(sc_time_stamp() - m_start);
+    u32 ticks = time_to_ticks(t - m_start);
     return (count + ticks) & counter_mask();
 }
 
 u32 nrf51::next_deadline() const {
     u32 deadline = 0;
-    u32 ticks = current_count();
+    u32 ticks = current_count(sc_time_stamp());
     u32 next;
     for (size_t i = 0; i < 4; i++) {
         if (compare[i] || !(m_inten & bit(16 + i)))
@@ -64,7 +64,7 @@ u32 nrf51::next_deadline() const {
 }
 
 void nrf51::update() {
-    count = current_count();
+    count = current_count(sc_time_stamp());
     m_start = sc_time_stamp();
 
     bool doirq = false;
@@ -90,6 +90,22 @@ void nrf51::update() {
     }
 }
 
+u32 nrf51::read_compare(size_t idx, const sc_time& t) {
+    if (compare[idx] || !m_running || !is_timer_mode() ||
+        !(m_inten & bit(16 + idx)))
+        return compare[idx];
+
+    // report events the initiator has already passed within its quantum,
+    // update will raise them once simulation time catches up
+    u32 ticks = current_count(sc_time_stamp());
+    u32 elapsed = time_to_ticks(t - m_start) -
+                  time_to_ticks(sc_time_stamp() - m_start);
+
+    u32 deadline = ticks > cc[idx] ? counter_mask() - ticks + cc[idx]
+                                   : cc[idx] - ticks;
+    return deadline && elapsed >= deadline ? 1 : 0;
+}
+
 void nrf51::write_start(u32 val) {
     if (m_running || val != 1u)
         return;
@@ -104,7 +120,7 @@ void nrf51::write_stop(u32 val) {
     if (!m_running || val != 1u)
         return;
 
-    count = current_count();
+    count = current_count(sc_time_stamp());
     m_running = false;
 }
 
@@ -129,7 +145,7 @@ void nrf51::write_shutdown(u32 val) {
 
 void nrf51::write_capture(u32 val, size_t idx) {
     if (val == 1) {
-        cc[idx] = current_count();
+        cc[idx] = current_count(sc_time_stamp());
         update();
     }
 }
@@ -183,49 +199,50 @@ nrf51::nrf51(const sc_module_name& nm):
     cc("cc", 0x540),
     in("in"),
     irq("irq") {
-    start.sync_always();
+    start.sync_on_write();
     start.allow_read_write();
     start.on_write(&nrf51::write_start);
 
-    stop.sync_always();
+    stop.sync_on_write();
     stop.allow_read_write();
     stop.on_write(&nrf51::write_stop);
 
-    count.sync_always();
+    count.sync_on_write();
     count.allow_read_write();
     count.on_write(&nrf51::write_count);
 
-    clear.sync_always();
+    clear.sync_on_write();
     clear.allow_read_write();
     clear.on_write(&nrf51::write_clear);
 
-    shutdown.sync_always();
+    shutdown.sync_on_write();
     shutdown.allow_read_write();
     shutdown.on_write(&nrf51::write_shutdown);
 
-    capture.sync_always();
+    capture.sync_on_write();
     capture.allow_read_write();
     capture.on_write(&nrf51::write_capture);
 
-    compare.sync_always();
+    compare.sync_on_write();
     compare.allow_read_write();
+    compare.on_read(&nrf51::read_compare);
     compare.on_write(&nrf51::write_compare);
 
-    shorts.sync_always();
+    shorts.sync_on_write();
     shorts.allow_read_write();
     shorts.on_write(&nrf51::write_shorts);
 
-    intenset.sync_always();
+    intenset.sync_on_write();
     intenset.allow_read_write();
     intenset.on_read([&]() -> u32 { return m_inten; });
     intenset.on_write(&nrf51::write_intenset);
 
-    intenclr.sync_always();
+    intenclr.sync_on_write();
     intenclr.allow_read_write();
     intenclr.on_read([&]() -> u32 { return m_inten; });
     intenclr.on_write(&nrf51::write_intenclr);
 
-    cc.sync_always();
+    cc.sync_on_write();
     cc.allow_read_write();
     cc.on_write(&nrf51::write_cc);
 
@@ -17,8 +17,8 @@ enum cr_bits : u32 {
     CR_ENABLE = bit(0),
 };
 
-u32 pl031::read_dr() {
-    return cr & CR_ENABLE ? m_offset + time_to_sec(sc_time_stamp()) : 0;
+u32 pl031::read_dr(const sc_time& t) {
+    return cr & CR_ENABLE ? m_offset + time_to_sec(t) : 0;
 }
 
 void pl031::write_mr(u32 val) {
@@ -27,7 +27,7 @@ void pl031::write_mr(u32 val) {
 }
 
 void pl031::write_lr(u32 val) {
-    m_offset += val - read_dr();
+    m_offset += val - read_dr(sc_time_stamp());
     lr = val;
     update();
 }
@@ -54,7 +54,7 @@ void pl031::write_icr(u32 val) {
 void pl031::update() {
     m_notify.cancel();
 
-    u32 next = mr - read_dr();
+    u32 next = mr - read_dr(sc_time_stamp());
     if (next == 0) {
         ris = 1;
     } else {
@@ -80,7 +80,7 @@ pl031::pl031(const sc_module_name& nm):
     cid("cid", 0xff0),
     in("in"),
     irq("irq") {
-    dr.sync_always();
+    dr.sync_never();
     dr.allow_read_only();
     dr.on_read(&pl031::read_dr);
 
@@ -44,11 +44,15 @@ void sp804::timer::schedule(u32 ticks) {
     m_ev.notify(delta);
 }
 
-u32 sp804::timer::read_value() {
-    if (!is_enabled())
+u32 sp804::timer::read_value(const sc_time& t) {
+    if (!is_enabled() || t <= m_prev)
         return load;
 
-    double delta = (sc_time_stamp() - m_prev) / (m_next - m_prev);
+    // the initiator may be ahead of the pending trigger event
+    if (t >= m_next)
+        return 0;
+
+    double delta = (t - m_prev) / (m_next - m_prev);
     return load * (1.0 - delta);
 }
 
@@ -101,7 +105,7 @@ sp804::timer::timer(const sc_module_name& nm):
     load.allow_read_write();
     load.on_write(&timer::write_load);
 
-    value.sync_always();
+    value.sync_never();
     value.allow_read_only();
     value.on_read(&timer::read_value);
 
@@ -182,23 +186,30 @@ sp804::~sp804() {
     // nothing to do
 }
 
+static unsigned int forward(peripheral& parent, peripheral& child,
+                            u64 offset, tlm_generic_payload& tx,
+                            const tlm_sbi& info, address_space as) {
+    u64 addr = tx.get_address();
+    tx.set_address(addr - offset);
+
+    // timers see and consume the quantum offset of the initiator
+    child.local_time() = parent.local_time();
+    unsigned int bytes = child.receive(tx, info, as);
+    parent.local_time() = child.local_time();
+
+    tx.set_address(addr);
+    return bytes;
+}
+
 unsigned int sp804::receive(tlm_generic_payload& tx, const tlm_sbi& info,
                             address_space as) {
     u64 addr = tx.get_address();
 
-    if ((addr >= TIMER1_START) && (addr <= TIMER1_END)) {
-        tx.set_address(addr - TIMER1_START);
-        unsigned int bytes = timer1.receive(tx, info, as);
-        tx.set_address(addr);
-        return bytes;
-    }
+    if ((addr >= TIMER1_START) && (addr <= TIMER1_END))
+        return forward(*this, timer1, TIMER1_START, tx, info, as);
 
-    if ((addr >= TIMER2_START) && (addr <= TIMER2_END)) {
-        tx.set_address(addr - TIMER2_START);
-        unsigned int bytes = timer2.receive(tx, info, as);
-        tx.set_address(addr);
-        return bytes;
-    }
+    if ((addr >= TIMER2_START) && (addr <= TIMER2_END))
+        return forward(*this, timer2, TIMER2_START, tx, info, as);
 
     return peripheral::receive(tx, info, as);
 }
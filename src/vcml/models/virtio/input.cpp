@@ -236,10 +236,6 @@ void input::update() {
             m_messages.pop();
         }
     }
-
-    sc_time quantum = tlm_global_quantum::instance().get();
-    sc_time polldelay = sc_time(1.0 / pollrate, SC_SEC);
-    next_trigger(max(polldelay, quantum));
 }
 
 void input::identify(virtio_device_desc& desc) {
@@ -257,6 +253,11 @@ bool input::notify(u32 vqid) {
     vq_message msg;
     while (virtio_in->get(vqid, msg))
         m_messages.push(msg);
+
+    // deliver events that were waiting for buffers
+    if (!m_events.empty())
+        m_input_ev.notify();
+
     return true;
 }
 
@@ -292,10 +293,10 @@ input::input(const sc_module_name& nm):
     m_keyboard(name()),
     m_pointer(name()),
     m_console(),
+    m_input_ev("input_ev"),
     touchpad("touchpad", false),
     keyboard("keyboard", true),
     mouse("mouse", true),
-    pollrate("pollrate", 1000),
     keymap("keymap", "us"),
     xmax("xmax", 0x7fff),
     ymax("ymax", 0x7fff),
@@ -308,8 +309,13 @@ input::input(const sc_module_name& nm):
         m_console.notify(m_pointer);
 
     if (keyboard || touchpad || mouse) {
+        m_keyboard.on_event([this]() -> void { m_input_ev.notify(); });
+        m_pointer.on_event([this]() -> void { m_input_ev.notify(); });
+
         SC_HAS_PROCESS(input);
         SC_METHOD(update);
+        sensitive << m_input_ev.event();
+        dont_initialize();
     }
 }
 
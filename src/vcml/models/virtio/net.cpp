@@ -240,6 +240,19 @@ bool net::handle_rx(vq_message& msg, eth_frame& frame) {
     hdr.gso_type = VIRTIO_NET_HDR_GSO_NONE;
     hdr.num_buffers = 1;
 
+    if (frame.offload.needs_csum() && !m_guest_csum)
+        frame.complete_checksum();
+
+    if (m_guest_csum) {
+        if (frame.offload.needs_csum()) {
+            hdr.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+            hdr.csum_start = frame.offload.csum_start;
+            hdr.csum_offset = frame.offload.csum_offset;
+        } else if (frame.offload.data_valid()) {
+            hdr.flags = VIRTIO_NET_HDR_F_DATA_VALID;
+        }
+    }
+
     msg.copy_out(hdr);
     msg.copy_out(frame.data(), frame.size(), sizeof(hdr));
     msg.trim(frame.size() + sizeof(hdr));
@@ -257,7 +270,7 @@ bool net::handle_tx(vq_message& msg) {
 
     msg.copy_in(header);
 
-    if (header.flags) {
+    if (header.flags & ~VIRTIO_NET_HDR_F_NEEDS_CSUM) {
         log_warn("unsupported packet flags: %hhx", header.flags);
         return false;
     }
@@ -270,6 +283,18 @@ bool net::handle_tx(vq_message& msg) {
     eth_frame frame(msg.length_in() - sizeof(header));
     msg.copy_in(frame.data(), frame.size(), sizeof(header));
 
+    if (header.flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+        size_t end = header.csum_start + header.csum_offset + sizeof(u16);
+        if (end > frame.size()) {
+            log_warn("invalid checksum offset: %hu", header.csum_offset);
+            return false;
+        }
+
+        frame.offload.flags = eth_offload::NEEDS_CSUM;
+        frame.offload.csum_start = header.csum_start;
+        frame.offload.csum_offset = header.csum_offset;
+    }
+
     if (frame.size() < eth_frame::FRAME_MIN_SIZE)
         frame.resize(eth_frame::FRAME_MIN_SIZE);
     if (frame.size() > m_config.mtu)
@@ -337,6 +362,8 @@ void net::read_features(u64& features) {
                VIRTIO_NET_F_CTRL_VQ | VIRTIO_NET_F_CTRL_RX |
                VIRTIO_NET_F_CTRL_RX_EXTRA | VIRTIO_NET_F_CTRL_ANNOUNCE |
                VIRTIO_NET_F_CTRL_MAC_ADDR;
+    if (csum_offload)
+        features |= VIRTIO_NET_F_CSUM | VIRTIO_NET_F_GUEST_CSUM;
 }
 
 bool net::write_features(u64 features) {
@@ -347,6 +374,7 @@ bool net::write_features(u64 features) {
         return false;
     }
 
+    m_guest_csum = features & VIRTIO_NET_F_GUEST_CSUM;
     return true;
 }
 
@@ -399,12 +427,14 @@ net::net(const sc_module_name& nm):
     m_nomulti(false),
     m_nouni(false),
     m_nobcast(false),
+    m_guest_csum(false),
     m_unicast(),
     m_multicast(),
     m_rxev("rxev"),
     m_txev("txev"),
     mac("mac"),
     mtu("mtu", 1500),
+    csum_offload("csum_offload", true),
     virtio_in("virtio_in"),
     eth_tx("eth_tx"),
     eth_rx("eth_rx") {
@@ -433,6 +463,7 @@ void net::reset() {
     m_nomulti = false;
     m_nouni = false;
     m_nobcast = false;
+    m_guest_csum = false;
 
     m_unicast.clear();
     m_multicast.clear();
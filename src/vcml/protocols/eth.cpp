@@ -76,6 +76,36 @@ eth_frame::eth_frame(const mac_addr& dest, const mac_addr& src,
         push_back(0);
 }
 
+bool eth_frame::complete_checksum() {
+    if (!offload.needs_csum())
+        return true;
+
+    size_t start = offload.csum_start;
+    size_t field = start + offload.csum_offset;
+    if (start >= size() || field + sizeof(u16) > size())
+        return false;
+
+    // the checksum field holds the pseudo header sum already, so folding
+    // everything from csum_start onwards yields the final checksum
+    u32 sum = 0;
+    const u8* ptr = data() + start;
+    size_t len = size() - start;
+    for (; len > 1; ptr += 2, len -= 2)
+        sum += (u32)ptr[0] << 8 | ptr[1];
+    if (len > 0)
+        sum += (u32)ptr[0] << 8;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+
+    u16 csum = ~sum;
+    at(field + 0) = csum >> 8;
+    at(field + 1) = csum & 0xff;
+
+    offload.flags &= ~eth_offload::NEEDS_CSUM;
+    offload.flags |= eth_offload::DATA_VALID;
+    return true;
+}
+
 u16 eth_frame::ether_type() const {
     u16 type = bswap(read<u16>(12));
     if (type == ETHER_TYPE_VLAN)
@@ -412,8 +442,17 @@ void eth_initiator_socket::send(eth_frame& frame) {
 
 void eth_target_socket::eth_transport(eth_frame& frame) {
     trace_fw(frame);
-    if (m_link_up)
-        m_host->eth_receive(*this, frame);
+    if (m_link_up) {
+        if (frame.offload.needs_csum() && !m_host->eth_rx_offload()) {
+            // the frame may be shared with other receivers that still want
+            // the partial checksum, so only complete it on a private copy
+            eth_frame copy(frame);
+            copy.complete_checksum();
+            m_host->eth_receive(*this, copy);
+        } else {
+            m_host->eth_receive(*this, frame);
+        }
+    }
     trace_bw(frame);
 }
 
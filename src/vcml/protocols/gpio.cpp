@@ -21,6 +21,87 @@ ostream& operator<<(ostream& os, const gpio_payload& tx) {
     return os;
 }
 
+ostream& operator<<(ostream& os, const gpio_bulk_payload& tx) {
+    stream_guard guard(os);
+    os << "GPIO:" << tx.base << " mask 0x" << std::hex << tx.mask
+       << " state 0x" << (tx.state & tx.mask);
+    return os;
+}
+
+bool gpio_state::read(gpio_vector vector) const {
+    if (vector == GPIO_NO_VECTOR)
+        return m_novec;
+    if (vector >= DENSE_LIMIT)
+        return stl_contains(m_sparse, vector);
+    size_t word = vector / 64;
+    if (word >= m_bits.size())
+        return false;
+    return (m_bits[word] >> (vector % 64)) & 1;
+}
+
+bool gpio_state::write(gpio_vector vector, bool state) {
+    if (read(vector) == state)
+        return false;
+
+    if (vector == GPIO_NO_VECTOR) {
+        m_novec = state;
+    } else if (vector >= DENSE_LIMIT) {
+        if (state)
+            m_sparse.insert(vector);
+        else
+            m_sparse.erase(vector);
+    } else {
+        size_t word = vector / 64;
+        if (word >= m_bits.size())
+            m_bits.resize(word + 1, 0);
+        m_bits[word] ^= 1ull << (vector % 64);
+    }
+
+    return true;
+}
+
+u64 gpio_state::read_mask(gpio_vector base) const {
+    if (base % 64 || base >= DENSE_LIMIT) {
+        u64 mask = 0;
+        for (size_t i = 0; i < 64 && base + i != GPIO_NO_VECTOR; i++)
+            mask |= (u64)read(base + i) << i;
+        return mask;
+    }
+
+    size_t word = base / 64;
+    return word < m_bits.size() ? m_bits[word] : 0;
+}
+
+u64 gpio_state::write_mask(gpio_vector base, u64 mask, u64 state) {
+    if (base % 64 || base >= DENSE_LIMIT) {
+        u64 changed = 0;
+        for (u64 bits = mask; bits; bits &= bits - 1) {
+            size_t i = ctz(bits);
+            if (base + i >= GPIO_NO_VECTOR)
+                break;
+            if (write(base + i, (state >> i) & 1))
+                changed |= 1ull << i;
+        }
+        return changed;
+    }
+
+    size_t word = base / 64;
+    if (word >= m_bits.size())
+        m_bits.resize(word + 1, 0);
+
+    u64 changed = (m_bits[word] ^ state) & mask;
+    m_bits[word] ^= changed;
+    return changed;
+}
+
+void gpio_host::gpio_bulk_transport(const gpio_target_socket& socket,
+                                    gpio_bulk_payload& tx) {
+    for (u64 bits = tx.changed; bits; bits &= bits - 1) {
+        gpio_payload gpio = tx.payload(ctz(bits));
+        gpio_transport(socket, gpio);
+    }
+}
+
 gpio_base_initiator_socket::gpio_base_initiator_socket(const char* nm,
                                                        address_space as):
     gpio_base_initiator_socket_b(nm, as), m_stub(nullptr), m_adapter(nullptr) {
@@ -87,31 +168,24 @@ void gpio_base_target_socket::stub() {
     m_stub->gpio_out.bind(*this);
 }
 
-void gpio_initiator_socket::gpio_state_tracker::write(bool val) {
-    if (state != val) {
-        state = val;
-        parent->gpio_transport(*this);
-    }
-}
-
 bool gpio_initiator_socket::gpio_state_tracker::operator=(bool val) {
     write(val);
-    return state;
+    return read();
 }
 
 bool gpio_initiator_socket::gpio_state_tracker::operator|=(bool val) {
-    write(state | val);
-    return state;
+    write(read() | val);
+    return read();
 }
 
 bool gpio_initiator_socket::gpio_state_tracker::operator&=(bool val) {
-    write(state & val);
-    return state;
+    write(read() & val);
+    return read();
 }
 
 bool gpio_initiator_socket::gpio_state_tracker::operator^=(bool val) {
-    write(state ^ val);
-    return state;
+    write(read() ^ val);
+    return read();
 }
 
 gpio_initiator_socket::gpio_initiator_socket(const char* nm, address_space as):
@@ -119,6 +193,7 @@ gpio_initiator_socket::gpio_initiator_socket(const char* nm, address_space as):
     m_host(dynamic_cast<gpio_host*>(hierarchy_top())),
     m_event(nullptr),
     m_state(),
+    m_trackers(),
     m_transport(this) {
     bind(m_transport);
 }
@@ -138,11 +213,34 @@ const sc_event& gpio_initiator_socket::default_event() {
 }
 
 bool gpio_initiator_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    return m_state.read(vector);
 }
 
 void gpio_initiator_socket::write(bool state, gpio_vector vector) {
-    (*this)[vector] = state;
+    if (m_state.write(vector, state)) {
+        gpio_payload tx;
+        tx.vector = vector;
+        tx.state = state;
+        gpio_transport(tx);
+    }
+}
+
+u64 gpio_initiator_socket::read_mask(gpio_vector base) const {
+    return m_state.read_mask(base);
+}
+
+void gpio_initiator_socket::write_mask(u64 mask, u64 state,
+                                       gpio_vector base) {
+    u64 changed = m_state.write_mask(base, mask, state);
+    if (!changed)
+        return;
+
+    gpio_bulk_payload tx;
+    tx.base = base;
+    tx.mask = changed;
+    tx.state = state & changed;
+    tx.changed = changed;
+    gpio_bulk_transport(tx);
 }
 
 void gpio_initiator_socket::raise(gpio_vector vector) {
@@ -180,15 +278,10 @@ gpio_initiator_socket& gpio_initiator_socket::operator^=(bool set) {
 
 gpio_initiator_socket::gpio_state_tracker& gpio_initiator_socket::operator[](
     gpio_vector vector) {
-    if (m_state.count(vector))
-        return m_state[vector];
-
-    gpio_state_tracker state;
-    state.parent = this;
-    state.state = false;
-    state.vector = vector;
-
-    return m_state[vector] = state;
+    gpio_state_tracker& tracker = m_trackers[vector];
+    tracker.parent = this;
+    tracker.vector = vector;
+    return tracker;
 }
 
 void gpio_initiator_socket::gpio_transport(gpio_payload& tx) {
@@ -200,6 +293,22 @@ void gpio_initiator_socket::gpio_transport(gpio_payload& tx) {
     trace_bw(tx);
 }
 
+void gpio_initiator_socket::gpio_bulk_transport(gpio_bulk_payload& tx) {
+    for (u64 bits = tx.mask; bits; bits &= bits - 1)
+        trace_fw(tx.payload(ctz(bits)));
+
+    for (int i = 0; i < size(); i++) {
+        tx.changed = 0;
+        get_interface(i)->gpio_bulk_transport(tx);
+    }
+
+    if (m_event)
+        m_event->notify(SC_ZERO_TIME);
+
+    for (u64 bits = tx.mask; bits; bits &= bits - 1)
+        trace_bw(tx.payload(ctz(bits)));
+}
+
 gpio_target_socket::gpio_target_socket(const char* nm, address_space space):
     gpio_base_target_socket(nm, space),
     m_host(hierarchy_search<gpio_host>()),
@@ -243,7 +352,11 @@ void gpio_target_socket::complete_binding(gpio_base_initiator_socket& socket) {
 }
 
 bool gpio_target_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    return m_state.read(vector);
+}
+
+u64 gpio_target_socket::read_mask(gpio_vector base) const {
+    return m_state.read_mask(base);
 }
 
 bool gpio_target_socket::operator==(const gpio_target_socket& other) const {
@@ -256,8 +369,7 @@ bool gpio_target_socket::operator!=(const gpio_target_socket& other) const {
 
 void gpio_target_socket::gpio_transport_internal(gpio_payload& tx) {
     trace_fw(tx);
-    if (m_state.count(tx.vector) == 0 || m_state[tx.vector] != tx.state) {
-        m_state[tx.vector] = tx.state;
+    if (m_state.write(tx.vector, tx.state)) {
         gpio_transport(tx);
         if (m_event)
             m_event->notify(SC_ZERO_TIME);
@@ -265,10 +377,31 @@ void gpio_target_socket::gpio_transport_internal(gpio_payload& tx) {
     trace_bw(tx);
 }
 
+void gpio_target_socket::gpio_bulk_transport_internal(gpio_bulk_payload& tx) {
+    // trace every vector of the bulk write just like individual writes, which
+    // get traced whether or not they change the state
+    for (u64 bits = tx.mask; bits; bits &= bits - 1)
+        trace_fw(tx.payload(ctz(bits)));
+
+    tx.changed = m_state.write_mask(tx.base, tx.mask, tx.state);
+    if (tx.changed) {
+        gpio_bulk_transport(tx);
+        if (m_event)
+            m_event->notify(SC_ZERO_TIME);
+    }
+
+    for (u64 bits = tx.mask; bits; bits &= bits - 1)
+        trace_bw(tx.payload(ctz(bits)));
+}
+
 void gpio_target_socket::gpio_transport(gpio_payload& tx) {
     m_host->gpio_transport(*this, tx);
 }
 
+void gpio_target_socket::gpio_bulk_transport(gpio_bulk_payload& tx) {
+    m_host->gpio_bulk_transport(*this, tx);
+}
+
 gpio_initiator_stub::gpio_initiator_stub(const char* nm):
     gpio_bw_transport_if(), gpio_out(mkstr("%s_stub", nm).c_str()) {
     gpio_out.bind(*(gpio_bw_transport_if*)this);
@@ -278,6 +411,10 @@ void gpio_target_stub::gpio_transport(gpio_payload& tx) {
     // nothing to do
 }
 
+void gpio_target_stub::gpio_bulk_transport(gpio_bulk_payload& tx) {
+    // nothing to do
+}
+
 gpio_target_stub::gpio_target_stub(const char* nm):
     gpio_fw_transport_if(), gpio_in(mkstr("%s_stub", nm).c_str()) {
     gpio_in.bind(*(gpio_fw_transport_if*)this);
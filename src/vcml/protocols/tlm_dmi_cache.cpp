@@ -44,7 +44,8 @@ static tlm_dmi dmi_merge(const tlm_dmi& a, const tlm_dmi& b) {
     return result;
 }
 
-tlm_dmi_cache::tlm_dmi_cache(): m_limit(16), m_entries() {
+tlm_dmi_cache::tlm_dmi_cache():
+    m_limit(16), m_deny_limit(256), m_entries(), m_denied() {
     // nothing to do
 }
 
@@ -74,8 +75,15 @@ void tlm_dmi_cache::insert_locked(const tlm_dmi& dmi) {
         m_entries.resize(m_limit);
 }
 
+void tlm_dmi_cache::allow_locked(const range& r) {
+    stl_remove_if(m_denied, [&r](const tlm_dmi_denial& d) {
+        return r.overlaps(d.addr);
+    });
+}
+
 void tlm_dmi_cache::insert(const tlm_dmi& dmi) {
     lock_guard<mutex> guard(m_mtx);
+    allow_locked(dmi);
     insert_locked(dmi);
 }
 
@@ -85,6 +93,8 @@ bool tlm_dmi_cache::invalidate(u64 start, u64 end) {
 
 bool tlm_dmi_cache::invalidate(const range& r) {
     lock_guard<mutex> guard(m_mtx);
+    allow_locked(r);
+
     vector<tlm_dmi> entries(m_entries.rbegin(), m_entries.rend());
     m_entries.clear();
 
@@ -116,6 +126,45 @@ bool tlm_dmi_cache::invalidate(const range& r) {
     return invalidations > 0;
 }
 
+void tlm_dmi_cache::deny(const range& r, vcml_access rwx) {
+    if (rwx == VCML_ACCESS_NONE)
+        return;
+
+    lock_guard<mutex> guard(m_mtx);
+    range merged(r);
+    auto mergeable = [&merged, rwx](const tlm_dmi_denial& d) -> bool {
+        return d.rwx == rwx &&
+               (d.addr.overlaps(merged) || d.addr.connects(merged));
+    };
+
+    for (const tlm_dmi_denial& d : m_denied) {
+        if (mergeable(d)) {
+            merged.start = min(merged.start, d.addr.start);
+            merged.end = max(merged.end, d.addr.end);
+        }
+    }
+
+    stl_remove_if(m_denied, mergeable);
+    m_denied.insert(m_denied.begin(), { merged, rwx });
+    if (m_denied.size() > m_deny_limit)
+        m_denied.resize(m_deny_limit);
+}
+
+void tlm_dmi_cache::allow(const range& r) {
+    lock_guard<mutex> guard(m_mtx);
+    allow_locked(r);
+}
+
+bool tlm_dmi_cache::is_denied(const range& r, vcml_access rwx) const {
+    // a target that refused reads will also refuse read-write requests, but
+    // a refused write says nothing about reads
+    lock_guard<mutex> guard(m_mtx);
+    for (const tlm_dmi_denial& d : m_denied)
+        if (r.inside(d.addr) && (d.rwx & ~rwx) == 0)
+            return true;
+    return false;
+}
+
 bool tlm_dmi_cache::lookup(const range& r, vcml_access rwx, tlm_dmi& out) {
     lock_guard<mutex> guard(m_mtx);
     for (unsigned int i = 0; i < m_entries.size(); i++) {
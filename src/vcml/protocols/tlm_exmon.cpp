@@ -12,78 +12,144 @@
 
 namespace vcml {
 
+void tlm_exmon::remove_lock(int cpu) {
+    if (cpu < 0 || (size_t)cpu >= m_slots.size() || !m_slots[cpu])
+        return;
+
+    range lock = *m_slots[cpu];
+    auto entries = m_index.equal_range(lock.start);
+    for (auto it = entries.first; it != entries.second; it++) {
+        if (it->second == cpu) {
+            m_index.erase(it);
+            break;
+        }
+    }
+
+    bool punched = m_punched[cpu];
+    m_slots[cpu].reset();
+    m_punched[cpu] = false;
+    m_count--;
+
+    if (punched && m_release)
+        m_release(lock);
+}
+
+vector<exlock> tlm_exmon::get_locks() const {
+    vector<exlock> locks;
+    for (size_t cpu = 0; cpu < m_slots.size(); cpu++)
+        if (m_slots[cpu])
+            locks.push_back({ (int)cpu, *m_slots[cpu] });
+    return locks;
+}
+
+tlm_exmon::tlm_exmon():
+    m_count(0),
+    m_maxlen(1),
+    m_slots(),
+    m_punched(),
+    m_index(),
+    m_release() {
+    // nothing to do
+}
+
 bool tlm_exmon::has_lock(int cpu, const range& r) const {
-    for (auto lock : m_locks)
-        if (lock.cpu == cpu && lock.addr.includes(r))
-            return true;
-    return false;
+    if (cpu < 0 || (size_t)cpu >= m_slots.size() || !m_slots[cpu])
+        return false;
+    return m_slots[cpu]->includes(r);
 }
 
 bool tlm_exmon::add_lock(int cpu, const range& r) {
     assert(cpu >= 0);
     break_locks(cpu);
-    m_locks.push_back({ cpu, r });
+
+    if ((size_t)cpu >= m_slots.size()) {
+        m_slots.resize(cpu + 1);
+        m_punched.resize(cpu + 1, false);
+    }
+
+    m_slots[cpu] = r;
+    m_index.emplace(r.start, cpu);
+    m_maxlen = max(m_maxlen, r.length());
+    m_count++;
     return true;
 }
 
 void tlm_exmon::break_locks(int cpu) {
     assert(cpu >= 0);
-    m_locks.erase(std::remove_if(m_locks.begin(), m_locks.end(),
-                                 [cpu](const exlock& lock) -> bool {
-                                     return lock.cpu == cpu;
-                                 }),
-                  m_locks.end());
+    remove_lock(cpu);
 }
 
 void tlm_exmon::break_locks(const range& r) {
-    m_locks.erase(std::remove_if(m_locks.begin(), m_locks.end(),
-                                 [r](const exlock& lock) -> bool {
-                                     return lock.addr.overlaps(r);
-                                 }),
-                  m_locks.end());
+    if (m_count == 0)
+        return;
+
+    vector<int> cpus;
+    for_each_overlap(r, [&cpus](int cpu, const range&) {
+        cpus.push_back(cpu);
+    });
+
+    for (int cpu : cpus)
+        remove_lock(cpu);
 }
 
 bool tlm_exmon::update(tlm_generic_payload& tx) {
-    for (auto lock : m_locks)
-        if (lock.addr.overlaps(tx))
-            tx.set_dmi_allowed(false);
+    sbiext* ex = tx.get_extension<sbiext>();
+    bool excl = ex != nullptr && ex->is_excl;
+
+    // fast path: no locks held and nothing to lock
+    if (m_count == 0 && !excl)
+        return true;
+
+    const range addr(tx);
+    for_each_overlap(addr, [&tx](int, const range&) {
+        tx.set_dmi_allowed(false);
+    });
 
     bool proceed = true;
-    sbiext* ex = tx.get_extension<sbiext>();
-    if (ex != nullptr && ex->is_excl) {
+    if (excl) {
         if (tx.is_read())
-            add_lock(ex->cpuid, tx);
+            add_lock(ex->cpuid, addr);
         if (tx.is_write())
-            ex->is_excl = has_lock(ex->cpuid, tx);
+            ex->is_excl = has_lock(ex->cpuid, addr);
         proceed = ex->is_excl;
     }
 
     if (tx.is_write())
-        break_locks(tx); // increase range to invalidate entire cache line?
+        break_locks(addr); // increase range to invalidate entire cache line?
 
     return proceed;
 }
 
 bool tlm_exmon::override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi) {
-    for (auto lock : m_locks) {
-        if (lock.addr.includes(tx.get_address())) {
-            dmi.set_start_address(0);
-            dmi.set_end_address((sc_dt::uint64)-1);
-            dmi.allow_read_write();
-            return false;
-        }
+    if (m_count == 0)
+        return true;
+
+    u64 addr = tx.get_address();
+    bool locked = false;
+    for_each_overlap({ addr, addr }, [&](int cpu, const range&) {
+        m_punched[cpu] = true;
+        locked = true;
+    });
+
+    if (locked) {
+        dmi.set_start_address(0);
+        dmi.set_end_address((sc_dt::uint64)-1);
+        dmi.allow_read_write();
+        return false;
     }
 
-    for (auto lock : m_locks) {
-        if (lock.addr.end < tx.get_address() &&
-            dmi.get_start_address() <= lock.addr.end) {
-            dmi_set_start_address(dmi, lock.addr.end + 1);
+    // only punch out the locks that actually fall into the granted region
+    for_each_overlap(dmi, [&](int cpu, const range& lock) {
+        if (lock.end < addr && dmi.get_start_address() <= lock.end) {
+            dmi_set_start_address(dmi, lock.end + 1);
+            m_punched[cpu] = true;
         }
-        if (lock.addr.start > tx.get_address() &&
-            dmi.get_end_address() >= lock.addr.start) {
-            dmi.set_end_address(lock.addr.start - 1);
+
+        if (lock.start > addr && dmi.get_end_address() >= lock.start) {
+            dmi.set_end_address(lock.start - 1);
+            m_punched[cpu] = true;
         }
-    }
+    });
 
     return true;
 }
@@ -48,7 +48,13 @@ int tlm_memory::init_shared(const string& shared, size_t size) {
 }
 
 tlm_memory::tlm_memory():
-    tlm_dmi(), m_handle(), m_base(), m_size(0), m_discard(false), m_shared() {
+    tlm_dmi(),
+    m_handle(),
+    m_base(),
+    m_size(0),
+    m_discard(false),
+    m_attached(false),
+    m_shared() {
 }
 
 tlm_memory::tlm_memory(size_t size): tlm_memory() {
@@ -73,7 +79,8 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_attached(other.m_attached) {
     other.m_handle = nullptr;
     other.m_base = nullptr;
     other.m_size = 0;
@@ -113,6 +120,68 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     set_start_address(0);
     set_end_address(size - 1);
     allow_read_write();
+
+    if (is_shared())
+        shared_memories().push_back(this);
+}
+
+void tlm_memory::attach(const string& shared, size_t size) {
+    VCML_ERROR_ON(m_size, "memory already initialized");
+    VCML_ERROR_ON(shared.empty(), "no shared memory name given");
+
+    int fd = shm_open(shared.c_str(), O_RDWR, 0600);
+    VCML_ERROR_ON(fd < 0, "cannot access shared memory '%s': %s",
+                  shared.c_str(), strerror(errno));
+
+    struct stat stat {};
+    if (fstat(fd, &stat) || (size_t)stat.st_size < size) {
+        close(fd);
+        VCML_ERROR("shared memory '%s' is smaller than %zu bytes",
+                   shared.c_str(), size);
+    }
+
+    void* base = mmap(0, size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_NORESERVE, fd, 0);
+    close(fd);
+    VCML_ERROR_ON(base == MAP_FAILED, "mmap failed: %s", strerror(errno));
+
+    m_base = base;
+    m_size = size;
+    m_shared = shared;
+    m_attached = true;
+
+    tlm_dmi::init();
+    set_dmi_ptr((u8*)m_base);
+    set_start_address(0);
+    set_end_address(size - 1);
+    allow_read_write();
+}
+
+void tlm_memory::unshare() {
+    if (!is_shared() || m_attached)
+        return;
+
+    int perms = PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
+    void* copy = mmap(0, m_size, perms, flags, -1, 0);
+    VCML_ERROR_ON(copy == MAP_FAILED, "mmap failed: %s", strerror(errno));
+    memcpy(copy, m_base, m_size);
+
+    void* base = mmap(m_base, m_size, perms, flags | MAP_FIXED, -1, 0);
+    VCML_ERROR_ON(base != m_base, "mmap failed: %s", strerror(errno));
+    memcpy(m_base, copy, m_size);
+    munmap(copy, m_size);
+
+    // the segment still belongs to the process that created it, so it must
+    // not be unlinked when this memory is freed
+    stl_remove(shared_memories(), this);
+    m_shared = "";
+}
+
+void tlm_memory::unshare_all() {
+    vector<tlm_memory*> memories = shared_memories();
+    for (tlm_memory* mem : memories)
+        mem->unshare();
 }
 
 void tlm_memory::free() {
@@ -121,9 +190,14 @@ void tlm_memory::free() {
         VCML_ERROR_ON(ret, "munmap failed: %d", ret);
     }
 
-    if (!m_shared.empty())
+    // attached segments belong to another process, which unlinks them
+    if (!m_shared.empty() && !m_attached)
         shm_unlink(m_shared.c_str());
 
+    if (!m_shared.empty() && !m_attached)
+        stl_remove(shared_memories(), this);
+
+    m_attached = false;
     m_shared = "";
     m_base = nullptr;
     m_size = 0;
@@ -48,6 +48,7 @@ tlm_memory::tlm_memory():
     m_base(nullptr),
     m_size(0),
     m_discard(false),
+    m_attached(false),
     m_shared() {
 }
 
@@ -73,7 +74,8 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_attached(other.m_attached) {
     other.m_handle = INVALID_HANDLE_VALUE;
     other.m_base = nullptr;
     other.m_size = 0;
@@ -107,6 +109,39 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     set_start_address(0);
     set_end_address(size - 1);
     allow_read_write();
+
+    if (is_shared())
+        shared_memories().push_back(this);
+}
+
+void tlm_memory::attach(const string& shared, size_t size) {
+    VCML_ERROR_ON(m_size, "memory already initialized");
+    VCML_ERROR_ON(shared.empty(), "no shared memory name given");
+
+    m_handle = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, shared.c_str());
+    VCML_ERROR_ON(m_handle == NULL, "cannot access shared memory '%s': %u",
+                  shared.c_str(), GetLastError());
+
+    m_base = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    VCML_ERROR_ON(!m_base, "MapViewOfFile failed: %u", GetLastError());
+
+    m_size = size;
+    m_shared = shared;
+    m_attached = true;
+
+    tlm_dmi::init();
+    set_dmi_ptr((u8*)m_base);
+    set_start_address(0);
+    set_end_address(size - 1);
+    allow_read_write();
+}
+
+void tlm_memory::unshare() {
+    // processes cannot be forked here, so nothing ever needs unsharing
+}
+
+void tlm_memory::unshare_all() {
+    // nothing to do
 }
 
 void tlm_memory::free() {
@@ -122,6 +157,10 @@ void tlm_memory::free() {
     if (m_base)
         VirtualFree(m_base, 0, MEM_RELEASE);
 
+    if (!m_shared.empty() && !m_attached)
+        stl_remove(shared_memories(), this);
+
+    m_attached = false;
     m_shared = "";
     m_size = 0;
 
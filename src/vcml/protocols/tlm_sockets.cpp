@@ -70,11 +70,16 @@ u8* tlm_initiator_socket::lookup_dmi_ptr(const range& mem, vcml_access rw) {
     if (dmi_cache().lookup(mem, rw, dmi))
         return dmi_get_ptr(dmi, mem.start);
 
+    if (dmi_cache().is_denied(mem, rw))
+        return nullptr;
+
     tlm_generic_payload tx;
     tlm_command cmd = tlm_command_from_access(rw);
     tx_setup(tx, cmd, mem.start, nullptr, mem.length());
-    if (!(*this)->get_direct_mem_ptr(tx, dmi))
+    if (!(*this)->get_direct_mem_ptr(tx, dmi)) {
+        dmi_cache().deny(mem, rw);
         return nullptr;
+    }
 
     map_dmi(dmi);
 
@@ -148,10 +153,16 @@ unsigned int tlm_initiator_socket::send(tlm_generic_payload& tx,
         bytes = 0;
 
     if (allow_dmi && tx.is_dmi_allowed()) {
-        tlm_dmi dmi;
         tx.set_address(addr);
-        if ((*this)->get_direct_mem_ptr(tx, dmi))
-            map_dmi(dmi);
+        const range mem(tx);
+        const vcml_access rwx = tlm_command_to_access(tx.get_command());
+        if (!dmi_cache().is_denied(mem, rwx)) {
+            tlm_dmi dmi;
+            if ((*this)->get_direct_mem_ptr(tx, dmi))
+                map_dmi(dmi);
+            else
+                dmi_cache().deny(mem, rwx);
+        }
     }
 
     return bytes;
@@ -232,6 +243,163 @@ tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
     return rs;
 }
 
+// Moves len bytes between buf and the segment list, starting at segment idx
+// and byte offset off, which are advanced past the copied data.
+static void copy_segments(const tlm_segment* segs, size_t& idx,
+                          unsigned int& off, u8* buf, u64 len, bool to_segs) {
+    for (u64 done = 0; done < len;) {
+        const tlm_segment& seg = segs[idx];
+        unsigned int n = (unsigned int)min<u64>(seg.size - off, len - done);
+        u8* ptr = (u8*)seg.data + off;
+
+        if (to_segs)
+            memcpy(ptr, buf + done, n);
+        else
+            memcpy(buf + done, ptr, n);
+
+        done += n;
+        off += n;
+        if (off == seg.size) {
+            idx++;
+            off = 0;
+        }
+    }
+}
+
+bool tlm_initiator_socket::lookup_dmi_run(tlm_command cmd, const range& run,
+                                          tlm_dmi& dmi) {
+    const range head(run.start, run.start);
+    if (dmi_cache().lookup(head, cmd, dmi))
+        return true;
+
+    const vcml_access rwx = tlm_command_to_access(cmd);
+    if (dmi_cache().is_denied(run, rwx))
+        return false;
+
+    tlm_generic_payload tx;
+    tx_setup(tx, cmd, run.start, nullptr, run.length());
+    if (!(*this)->get_direct_mem_ptr(tx, dmi)) {
+        dmi_cache().deny(run, rwx);
+        return false;
+    }
+
+    map_dmi(dmi);
+
+    // granted region may end before the run does, which is fine as long as
+    // it covers at least its start
+    return head.inside(dmi) && dmi_check_access(dmi, rwx);
+}
+
+tlm_response_status tlm_initiator_socket::access_run(
+    tlm_command cmd, const tlm_segment* segs, size_t count, u64 size,
+    const tlm_sbi& info, unsigned int& nbytes) {
+    u64 addr = segs[0].addr;
+    size_t idx = 0;
+    unsigned int off = 0;
+
+    bool use_dmi = allow_dmi && cmd != TLM_IGNORE_COMMAND && !info.is_nodmi &&
+                   !info.is_excl;
+    tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
+
+    tlm_dmi dmi;
+    while (use_dmi && size > 0 &&
+           lookup_dmi_run(elevate, { addr, addr + size - 1 }, dmi)) {
+        u64 len = min(size, dmi.get_end_address() - addr + 1);
+        bool rd = cmd == TLM_READ_COMMAND;
+        copy_segments(segs, idx, off, dmi_get_ptr(dmi, addr), len, rd);
+
+        if (!info.is_debug) {
+            m_host->local_time() += rd ? dmi.get_read_latency()
+                                       : dmi.get_write_latency();
+        }
+
+        addr += len;
+        size -= len;
+        nbytes += len;
+    }
+
+    if (size == 0)
+        return TLM_OK_RESPONSE;
+
+    // everything not covered by dmi goes out as a single transaction, using
+    // a bounce buffer if the remaining segments are not contiguous in memory
+    u8* data = (u8*)segs[idx].data + off;
+    u8* next = data + (segs[idx].size - off);
+    bool contiguous = true;
+    for (size_t i = idx + 1; i < count && contiguous; i++) {
+        if (segs[i].size == 0)
+            continue;
+        contiguous = segs[i].data == next;
+        next = (u8*)segs[i].data + segs[i].size;
+    }
+
+    vector<u8> bounce;
+    if (!contiguous) {
+        bounce.resize(size);
+        if (cmd == TLM_WRITE_COMMAND) {
+            size_t i = idx;
+            unsigned int o = off;
+            copy_segments(segs, i, o, bounce.data(), size, false);
+        }
+
+        data = bounce.data();
+    }
+
+    auto& tx = info.is_debug ? m_txd : m_tx;
+    tx_setup(tx, cmd, addr, data, size);
+    unsigned int n = send(tx, info);
+
+    tlm_response_status rs = tx.get_response_status();
+    if (rs == TLM_INCOMPLETE_RESPONSE && info.is_debug)
+        rs = TLM_OK_RESPONSE;
+
+    if (rs == TLM_INCOMPLETE_RESPONSE)
+        m_parent->log_warn("got incomplete response from 0x%016llx", addr);
+
+    if (!contiguous && cmd == TLM_READ_COMMAND && success(rs))
+        copy_segments(segs, idx, off, bounce.data(), size, true);
+
+    nbytes += n;
+    return rs;
+}
+
+tlm_response_status tlm_initiator_socket::accessv(tlm_command cmd,
+                                                  const tlm_segment* segs,
+                                                  size_t count,
+                                                  const tlm_sbi& info,
+                                                  unsigned int* nbytes) {
+    if (!info.is_debug && !is_thread())
+        VCML_ERROR("non-debug TLM access outside SC_THREAD forbidden");
+
+    if (info.is_sync && !info.is_debug)
+        m_host->sync();
+
+    unsigned int total = 0;
+    tlm_response_status rs = TLM_OK_RESPONSE;
+    for (size_t i = 0, j = 0; i < count && success(rs); i = j) {
+        // coalesce segments that continue where their predecessor ended
+        u64 size = segs[i].size;
+        for (j = i + 1; j < count; j++) {
+            if (segs[j].addr != segs[i].addr + size)
+                break;
+            if (size + segs[j].size > std::numeric_limits<u32>::max())
+                break;
+            size += segs[j].size;
+        }
+
+        if (size > 0)
+            rs = access_run(cmd, segs + i, j - i, size, info, total);
+    }
+
+    if (info.is_sync && !info.is_debug)
+        m_host->sync();
+
+    if (nbytes != nullptr)
+        *nbytes = total;
+
+    return rs;
+}
+
 void tlm_initiator_socket::stub(tlm_response_status r) {
     VCML_ERROR_ON(m_stub, "socket %s already stubbed", name());
     hierarchy_guard guard(m_parent);
@@ -341,6 +509,13 @@ tlm_target_socket::tlm_target_socket(const char* nm, address_space a):
 
     m_host->register_socket(this);
 
+    // once a lock that refused or shrunk a dmi request is gone, initiators
+    // may map the punched range again
+    m_exmon.on_release([this](const range& lock) -> void {
+        if (allow_dmi)
+            (*this)->invalidate_direct_mem_ptr(lock.start, lock.end);
+    });
+
     register_b_transport(this, &tlm_target_socket::b_transport_int);
     register_transport_dbg(this, &tlm_target_socket::transport_dbg_int);
     register_get_direct_mem_ptr(this, &tlm_target_socket::get_dmi_ptr_int);
@@ -22,6 +22,10 @@
 #include "vcml/ui/rfb.h"
 #endif
 
+#ifdef MWR_LINUX
+#include "vcml/ui/shm.h"
+#endif
+
 namespace vcml {
 namespace ui {
 
@@ -123,6 +127,9 @@ unordered_map<string, function<display*(u32)>> display::types = {
 #ifdef HAVE_LIBRFB
     { "rfb", rfb::create },
 #endif
+#ifdef MWR_LINUX
+    { "shm", shm::create },
+#endif
 };
 
 unordered_map<string, shared_ptr<display>> display::displays = {
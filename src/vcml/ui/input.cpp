@@ -14,8 +14,17 @@ namespace vcml {
 namespace ui {
 
 void input::push_event(const input_event& ev) {
-    lock_guard<mutex> lock(m_mutex);
-    m_events.push(ev);
+    function<void(void)> notify;
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_events.empty())
+            notify = m_notify;
+        m_events.push(ev);
+    }
+
+    if (notify)
+        notify();
 }
 
 void input::push_key(u32 key, u32 state) {
@@ -35,7 +44,8 @@ void input::push_rel(i32 x, i32 y, i32 w) {
     push_event(ev);
 }
 
-input::input(const char* name): m_name(name), m_mutex(), m_events() {
+input::input(const char* name):
+    m_name(name), m_mutex(), m_events(), m_notify() {
 }
 
 input::~input() {
@@ -57,6 +67,11 @@ bool input::pop_event(input_event& ev) {
     return true;
 }
 
+void input::on_event(function<void(void)> notify) {
+    lock_guard<mutex> lock(m_mutex);
+    m_notify = std::move(notify);
+}
+
 keyboard::keyboard(const char* name, const string& layout):
     input(name),
     m_shift_l(false),
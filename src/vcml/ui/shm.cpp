@@ -0,0 +1,142 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/ui/shm.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+
+namespace vcml {
+namespace ui {
+
+static void futex_wake_all(u32* addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+static vcml_shmfb_channel shmfb_channel(const color_channel& ch) {
+    return { ch.offset, ch.size };
+}
+
+void shm::ring_doorbell(u32 x, u32 y, u32 w, u32 h) {
+    u32 seq = m_header->seq;
+    m_header->damage[seq % VCML_SHMFB_DAMAGE] = { x, y, w, h };
+    // both need to be sequentially consistent: a release store followed by
+    // an acquire load may be reordered, so we could miss a viewer that
+    // registered itself as waiter just before we published the update
+    __atomic_store_n(&m_header->seq, seq + 1, __ATOMIC_SEQ_CST);
+
+    // only enter the kernel if a viewer is actually asleep
+    if (__atomic_load_n(&m_header->waiters, __ATOMIC_SEQ_CST))
+        futex_wake_all(&m_header->seq);
+}
+
+shm::shm(u32 nr): display("shm", nr), m_mem(), m_header(), m_pixels() {
+    // nothing to do
+}
+
+shm::~shm() {
+    shutdown();
+}
+
+void shm::init(const videomode& mode, u8* fb) {
+    display::init(mode, fb);
+
+    // guest framebuffers in shared memory are exported as they are
+    size_t offset = 0;
+    const tlm_memory* fbmem = tlm_memory::find_shared(framebuffer(), offset);
+    if (fbmem && offset + mode.size > fbmem->shared_size())
+        fbmem = nullptr;
+
+    size_t size = sizeof(vcml_shmfb_header);
+    if (fbmem == nullptr)
+        size += mode.size;
+
+    // remove leftovers of a previous simulation that did not exit cleanly
+    string name = mkstr(VCML_SHMFB_NAME, dispno());
+    shm_unlink(name.c_str());
+    m_mem.init(name, size, VCML_ALIGN_4K);
+
+    m_header = (vcml_shmfb_header*)m_mem.data();
+    m_header->magic = VCML_SHMFB_MAGIC;
+    m_header->version = VCML_SHMFB_VERSION;
+    m_header->xres = mode.xres;
+    m_header->yres = mode.yres;
+    m_header->bpp = mode.bpp;
+    m_header->stride = mode.stride;
+    m_header->big_endian = mode.endian == ENDIAN_BIG;
+    m_header->a = shmfb_channel(mode.a);
+    m_header->r = shmfb_channel(mode.r);
+    m_header->g = shmfb_channel(mode.g);
+    m_header->b = shmfb_channel(mode.b);
+    m_header->fb_size = mode.size;
+
+    if (fbmem) {
+        strncpy(m_header->fb_name, fbmem->shared_name(),
+                sizeof(m_header->fb_name) - 1);
+        m_header->fb_offset = offset;
+        m_pixels = nullptr;
+        log_debug("exporting %s framebuffer from %s", name.c_str(),
+                  fbmem->shared_name());
+    } else {
+        m_header->fb_offset = sizeof(vcml_shmfb_header);
+        m_pixels = m_mem.data() + m_header->fb_offset;
+        memcpy(m_pixels, framebuffer(), mode.size);
+        log_debug("exporting %s framebuffer by copy", name.c_str());
+    }
+
+    __atomic_store_n(&m_header->state, VCML_SHMFB_ACTIVE, __ATOMIC_RELEASE);
+    ring_doorbell(0, 0, xres(), yres());
+}
+
+void shm::render(u32 x, u32 y, u32 w, u32 h) {
+    if (m_header == nullptr || x >= xres() || y >= yres())
+        return;
+
+    if (x + w > xres())
+        w = xres() - x;
+    if (y + h > yres())
+        h = yres() - y;
+
+    if (m_pixels != nullptr) {
+        const videomode& fbm = mode();
+        size_t offset = y * fbm.stride + x * fbm.bpp;
+        for (u32 line = 0; line < h; line++, offset += fbm.stride)
+            memcpy(m_pixels + offset, framebuffer() + offset, w * fbm.bpp);
+    }
+
+    ring_doorbell(x, y, w, h);
+}
+
+void shm::render() {
+    render(0, 0, xres(), yres());
+}
+
+void shm::shutdown() {
+    if (m_header != nullptr) {
+        __atomic_store_n(&m_header->state, VCML_SHMFB_CLOSED,
+                         __ATOMIC_RELEASE);
+        ring_doorbell(0, 0, 0, 0);
+        futex_wake_all(&m_header->seq);
+        m_mem.free();
+    }
+
+    m_header = nullptr;
+    m_pixels = nullptr;
+    display::shutdown();
+}
+
+display* shm::create(u32 nr) {
+    return new shm(nr);
+}
+
+} // namespace ui
+} // namespace vcml
@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_UI_SHM_H
+#define VCML_UI_SHM_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/logging/logger.h"
+#include "vcml/protocols/tlm_memory.h"
+
+#include "vcml/ui/video.h"
+#include "vcml/ui/display.h"
+#include "vcml/ui/shmfb.h"
+
+namespace vcml {
+namespace ui {
+
+// Publishes the framebuffer in a shared memory segment so that viewers in
+// other processes can pick it up without any encoding in the simulator.
+class shm : public display
+{
+private:
+    tlm_memory m_mem;
+    vcml_shmfb_header* m_header;
+    u8* m_pixels;
+
+    void ring_doorbell(u32 x, u32 y, u32 w, u32 h);
+
+public:
+    const char* segment_name() const { return m_mem.shared_name(); }
+
+    shm(u32 nr);
+    virtual ~shm();
+
+    virtual void init(const videomode& mode, u8* fb) override;
+    virtual void render(u32 x, u32 y, u32 w, u32 h) override;
+    virtual void render() override;
+    virtual void shutdown() override;
+
+    static display* create(u32 nr);
+};
+
+} // namespace ui
+} // namespace vcml
+
+#endif
@@ -0,0 +1,147 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <filesystem>
+
+#include "testing.h"
+
+using namespace vcml;
+
+class ckpt_test_module : public module
+{
+public:
+    property<u32> value;
+    property<string> text;
+
+    u64 counter;
+    vector<u8> buffer;
+
+    ckpt_test_module(const sc_module_name& nm):
+        module(nm),
+        value("value", 0),
+        text("text", ""),
+        counter(0),
+        buffer(3 * checkpoint::SPARSE_PAGE_SIZE + 17) {}
+
+    virtual void serialize(checkpoint& ckpt) override {
+        module::serialize(ckpt);
+        ckpt.value("counter", counter);
+        ckpt.sparse("buffer", buffer.data(), buffer.size());
+    }
+};
+
+TEST(checkpoint, save_restore) {
+    string dir = std::filesystem::temp_directory_path() / "vcml_ckpt_test";
+    std::filesystem::remove_all(dir);
+
+    ckpt_test_module mod("ckpt");
+    mod.value = 42;
+    mod.text = "multi\nline \\ text";
+    mod.counter = 0x1234567890;
+    mod.buffer[5] = 0xaa;
+    mod.buffer[mod.buffer.size() - 1] = 0x55;
+
+    {
+        checkpoint ckpt(dir, checkpoint::CHECKPOINT_SAVE);
+        ckpt.enter(mod);
+        mod.serialize(ckpt);
+        ckpt.leave();
+        ckpt.commit();
+    }
+
+    // the untouched middle pages must not end up in the file
+    auto size = std::filesystem::file_size(dir + "/ckpt.buffer.bin");
+    EXPECT_LT(size, 2 * checkpoint::SPARSE_PAGE_SIZE + 64);
+
+    mod.value = 0;
+    mod.text = "";
+    mod.counter = 0;
+    mod.buffer[5] = 0;
+    mod.buffer[checkpoint::SPARSE_PAGE_SIZE + 3] = 0xff;
+    mod.buffer[mod.buffer.size() - 1] = 0;
+
+    {
+        checkpoint ckpt(dir, checkpoint::CHECKPOINT_RESTORE);
+        ckpt.enter(mod);
+        mod.serialize(ckpt);
+        ckpt.leave();
+        EXPECT_EQ(ckpt.missing(), 0);
+        EXPECT_FALSE(ckpt.has("ckpt.nothing"));
+    }
+
+    EXPECT_EQ(mod.value.get(), 42);
+    EXPECT_EQ(mod.text.get(), "multi\nline \\ text");
+    EXPECT_EQ(mod.counter, 0x1234567890);
+    EXPECT_EQ(mod.buffer[5], 0xaa);
+    EXPECT_EQ(mod.buffer[checkpoint::SPARSE_PAGE_SIZE + 3], 0);
+    EXPECT_EQ(mod.buffer[mod.buffer.size() - 1], 0x55);
+
+    std::filesystem::remove_all(dir);
+}
+
+class ckpt_test_peripheral : public peripheral
+{
+public:
+    reg<u32, 2> banked;
+
+    ckpt_test_peripheral(const sc_module_name& nm):
+        peripheral(nm), banked("banked", 0x0, 0) {
+        banked.set_banked();
+    }
+};
+
+TEST(checkpoint, banked_registers) {
+    string dir = std::filesystem::temp_directory_path() / "vcml_ckpt_banks";
+    std::filesystem::remove_all(dir);
+
+    ckpt_test_peripheral mod("ckpt_banks");
+    mod.banked.bank(0, 1) = 0x10;
+    mod.banked.bank(1, 0) = 0x21;
+    mod.banked.bank(1, 1) = 0x22;
+    mod.banked.bank(3, 1) = 0x32;
+
+    {
+        checkpoint ckpt(dir, checkpoint::CHECKPOINT_SAVE);
+        ckpt.enter(mod);
+        mod.serialize(ckpt);
+        ckpt.leave();
+        ckpt.commit();
+    }
+
+    mod.banked.bank(0, 1) = 0;
+    mod.banked.bank(1, 0) = 0;
+    mod.banked.bank(1, 1) = 0;
+    mod.banked.bank(3, 1) = 0;
+    mod.banked.bank(4, 0) = 0x40;
+
+    {
+        checkpoint ckpt(dir, checkpoint::CHECKPOINT_RESTORE);
+        ckpt.enter(mod);
+        mod.serialize(ckpt);
+        ckpt.leave();
+        EXPECT_EQ(ckpt.missing(), 0);
+        EXPECT_TRUE(ckpt.has("ckpt_banks.banked@1"));
+        EXPECT_FALSE(ckpt.has("ckpt_banks.banked@4"));
+    }
+
+    EXPECT_EQ(mod.banked.bank(0, 1), 0x10);
+    EXPECT_EQ(mod.banked.bank(1, 0), 0x21);
+    EXPECT_EQ(mod.banked.bank(1, 1), 0x22);
+    EXPECT_EQ(mod.banked.bank(3, 0), 0);
+    EXPECT_EQ(mod.banked.bank(3, 1), 0x32);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(checkpoint, missing) {
+    EXPECT_THROW(checkpoint("/nonexistent/ckpt",
+                            checkpoint::CHECKPOINT_RESTORE),
+                 vcml::report);
+}
@@ -13,6 +13,12 @@
 #include <gtest/gtest.h>
 #include "vcml.h"
 
+#ifdef MWR_LINUX
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace vcml;
 using namespace vcml::ui;
 
@@ -92,3 +98,47 @@ TEST(display, server) {
     p4->shutdown();
     p5->shutdown();
 }
+
+#ifdef MWR_LINUX
+TEST(display, shm) {
+    u32 nr = (u32)mwr::getpid();
+    shared_ptr<display> disp = display::lookup(mkstr("shm:%u", nr));
+    ASSERT_TRUE(disp);
+    EXPECT_STREQ(disp->type(), "shm");
+
+    videomode mode = videomode::a8r8g8b8(64, 32);
+    vector<u8> fb(mode.size, 0x11);
+    disp->init(mode, fb.data());
+
+    // map the segment like an external viewer would
+    string name = mkstr(VCML_SHMFB_NAME, nr);
+    size_t size = sizeof(vcml_shmfb_header) + mode.size;
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(ptr, MAP_FAILED);
+    auto* hdr = (vcml_shmfb_header*)ptr;
+
+    EXPECT_EQ(hdr->magic, VCML_SHMFB_MAGIC);
+    EXPECT_EQ(hdr->state, VCML_SHMFB_ACTIVE);
+    EXPECT_EQ(hdr->xres, 64);
+    EXPECT_EQ(hdr->yres, 32);
+    EXPECT_STREQ(hdr->fb_name, "");
+
+    const u8* pixels = (const u8*)ptr + hdr->fb_offset;
+    EXPECT_EQ(pixels[0], 0x11);
+
+    u32 seq = hdr->seq;
+    fb[mode.stride + 4] = 0x22;
+    disp->render(1, 1, 2, 2);
+    EXPECT_EQ(hdr->seq, seq + 1);
+    EXPECT_EQ(pixels[mode.stride + 4], 0x22);
+    EXPECT_EQ(hdr->damage[seq % VCML_SHMFB_DAMAGE].x, 1);
+    EXPECT_EQ(hdr->damage[seq % VCML_SHMFB_DAMAGE].w, 2);
+
+    disp->shutdown();
+    EXPECT_EQ(hdr->state, VCML_SHMFB_CLOSED);
+    munmap(ptr, size);
+}
+#endif
@@ -108,3 +108,59 @@ TEST(dmi, lookup) {
     EXPECT_EQ(vcml::dmi_get_ptr(dmi2, 997), dummy + 997);
     EXPECT_FALSE(cache.lookup(998, 4, tlm::TLM_READ_COMMAND, dmi2));
 }
+
+TEST(dmi, deny) {
+    unsigned char dummy[4096];
+    vcml::tlm_dmi_cache cache;
+    tlm::tlm_dmi dmi;
+
+    cache.deny({ 100, 103 });
+    cache.deny({ 104, 107 });
+    cache.deny({ 200, 203 });
+    EXPECT_EQ(cache.get_denied().size(), 2);
+    EXPECT_TRUE(cache.is_denied({ 100, 107 }));
+    EXPECT_TRUE(cache.is_denied({ 200, 201 }));
+    EXPECT_FALSE(cache.is_denied({ 96, 103 }));
+    EXPECT_FALSE(cache.is_denied({ 300, 303 }));
+
+    cache.invalidate(104, 104);
+    EXPECT_FALSE(cache.is_denied({ 100, 103 }));
+    EXPECT_TRUE(cache.is_denied({ 200, 203 }));
+
+    dmi.allow_read_write();
+    dmi.set_start_address(0);
+    dmi.set_end_address(1000);
+    dmi.set_dmi_ptr(dummy + dmi.get_start_address());
+    cache.insert(dmi);
+    EXPECT_FALSE(cache.is_denied({ 200, 203 }));
+    EXPECT_TRUE(cache.get_denied().empty());
+
+    cache.deny({ 2000, 2003 });
+    cache.allow({ 2002, 2002 });
+    EXPECT_FALSE(cache.is_denied({ 2000, 2003 }));
+}
+
+TEST(dmi, deny_access) {
+    vcml::tlm_dmi_cache cache;
+
+    // a refused write probe must not hold back reads of the same range
+    cache.deny({ 100, 103 }, vcml::VCML_ACCESS_WRITE);
+    EXPECT_TRUE(cache.is_denied({ 100, 103 }, vcml::VCML_ACCESS_WRITE));
+    EXPECT_TRUE(cache.is_denied({ 100, 103 }, vcml::VCML_ACCESS_READ_WRITE));
+    EXPECT_FALSE(cache.is_denied({ 100, 103 }, vcml::VCML_ACCESS_READ));
+
+    cache.deny({ 104, 107 }, vcml::VCML_ACCESS_READ);
+    EXPECT_EQ(cache.get_denied().size(), 2);
+    EXPECT_TRUE(cache.is_denied({ 104, 107 }, vcml::VCML_ACCESS_READ));
+    EXPECT_TRUE(cache.is_denied({ 104, 107 }, vcml::VCML_ACCESS_READ_WRITE));
+    EXPECT_FALSE(cache.is_denied({ 104, 107 }, vcml::VCML_ACCESS_WRITE));
+    EXPECT_FALSE(cache.is_denied({ 100, 107 }, vcml::VCML_ACCESS_READ));
+
+    // denials have their own limit, independent of the grants
+    for (vcml::u64 addr = 0x1000; addr < 0x1000 + 64 * 8; addr += 8)
+        cache.deny({ addr, addr + 3 });
+    EXPECT_GT(cache.get_denial_limit(), cache.get_entry_limit());
+    EXPECT_EQ(cache.get_denied().size(), 66);
+    EXPECT_TRUE(cache.is_denied({ 0x1000, 0x1003 }));
+    EXPECT_TRUE(cache.is_denied({ 100, 103 }, vcml::VCML_ACCESS_WRITE));
+}
@@ -48,6 +48,42 @@ TEST(ethernet, frame) {
     EXPECT_FALSE(failed(frame));
 }
 
+static u16 eth_fold(const eth_frame& frame, size_t start, u32 sum) {
+    for (size_t i = start; i < frame.size(); i += 2) {
+        sum += (u32)frame[i] << 8;
+        if (i + 1 < frame.size())
+            sum += frame[i + 1];
+    }
+
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return sum;
+}
+
+TEST(ethernet, checksum) {
+    eth_frame frame(75);
+    for (size_t i = 0; i < frame.size(); i++)
+        frame[i] = i * 7 + 3;
+
+    frame.offload.flags = eth_offload::NEEDS_CSUM;
+    frame.offload.csum_start = 34;
+    frame.offload.csum_offset = 6;
+    frame[40] = 0x12; // partial pseudo header sum
+    frame[41] = 0x34;
+
+    EXPECT_TRUE(frame.complete_checksum());
+    EXPECT_FALSE(frame.offload.needs_csum());
+    EXPECT_TRUE(frame.offload.data_valid());
+    EXPECT_EQ(eth_fold(frame, 34, 0x1234), 0xffff);
+
+    eth_frame broken(64);
+    broken.offload.flags = eth_offload::NEEDS_CSUM;
+    broken.offload.csum_start = 60;
+    broken.offload.csum_offset = 6;
+    EXPECT_FALSE(broken.complete_checksum());
+    EXPECT_TRUE(broken.offload.needs_csum());
+}
+
 MATCHER_P(eth_match_socket, socket, "Matches an ethernet socket") {
     return &arg == socket;
 }
@@ -125,6 +161,19 @@ public:
 
         EXPECT_CALL(*this, eth_receive(_, eth_match_frame(frame)));
         eth_tx.send(frame);
+
+        // receivers without rx offload get the checksum completed on a copy
+        eth_frame partial(frame);
+        partial.offload.flags = eth_offload::NEEDS_CSUM;
+        partial.offload.csum_start = 14;
+        partial.offload.csum_offset = 2;
+        eth_frame completed(partial);
+        ASSERT_TRUE(completed.complete_checksum());
+
+        EXPECT_CALL(*this, eth_receive(_, eth_match_frame(completed)));
+        eth_tx.send(partial);
+        EXPECT_TRUE(partial.offload.needs_csum()) << "sent frame was modified";
+        EXPECT_NE(partial, completed) << "sent frame was modified";
     }
 };
 
@@ -8,10 +8,7 @@
  *                                                                            *
  ******************************************************************************/
 
-#include <gtest/gtest.h>
-using namespace ::testing;
-
-#include "vcml.h"
+#include "testing.h"
 
 TEST(tlm_exmon, locking) {
     vcml::tlm_exmon mon;
@@ -24,6 +21,54 @@ TEST(tlm_exmon, locking) {
     EXPECT_TRUE(mon.get_locks().empty());
 }
 
+TEST(tlm_exmon, release) {
+    vcml::tlm_exmon mon;
+    std::vector<vcml::range> released;
+    mon.on_release([&](const vcml::range& r) { released.push_back(r); });
+
+    EXPECT_FALSE(mon.has_locks());
+    mon.add_lock(0, { 0x1000, 0x1003 });
+    mon.add_lock(1, { 0x2000, 0x2007 });
+    mon.add_lock(2, { 0x1000, 0x1003 });
+    mon.add_lock(3, { 0x4000, 0x4003 });
+    EXPECT_TRUE(mon.has_locks());
+    EXPECT_TRUE(mon.has_lock(1, { 0x2004, 0x2007 }));
+    EXPECT_FALSE(mon.has_lock(0, { 0x2004, 0x2007 }));
+
+    // only locks that refused or shrunk a dmi request get reported
+    tlm::tlm_generic_payload tx;
+    tlm::tlm_dmi dmi;
+    dmi.set_start_address(0);
+    dmi.set_end_address(0x3fff);
+    tx.set_address(0x1000);
+    EXPECT_FALSE(mon.override_dmi(tx, dmi));
+    dmi.set_start_address(0);
+    dmi.set_end_address(0x3fff);
+    tx.set_address(0x1800);
+    EXPECT_TRUE(mon.override_dmi(tx, dmi));
+    EXPECT_EQ(dmi.get_start_address(), 0x1004);
+    EXPECT_EQ(dmi.get_end_address(), 0x1fff);
+
+    mon.break_locks({ 0x4000, 0x4000 });
+    EXPECT_TRUE(released.empty());
+    EXPECT_EQ(mon.get_locks().size(), 3);
+
+    mon.break_locks({ 0x2006, 0x2006 });
+    ASSERT_EQ(released.size(), 1);
+    EXPECT_EQ(released[0], vcml::range(0x2000, 0x2007));
+    EXPECT_EQ(mon.get_locks().size(), 2);
+
+    mon.add_lock(0, { 0x3000, 0x3003 });
+    ASSERT_EQ(released.size(), 2);
+    EXPECT_EQ(released[1], vcml::range(0x1000, 0x1003));
+    EXPECT_TRUE(mon.has_lock(2, { 0x1000, 0x1003 }));
+
+    mon.break_locks({ 0, 0xffff });
+    ASSERT_EQ(released.size(), 3);
+    EXPECT_EQ(released[2], vcml::range(0x1000, 0x1003));
+    EXPECT_FALSE(mon.has_locks());
+}
+
 TEST(tlm_exmon, update) {
     vcml::tlm_exmon mon;
 
@@ -114,3 +159,61 @@ TEST(tlm_exmon, dmi) {
     EXPECT_EQ(dmi.get_end_address(), -1);
     EXPECT_EQ(dmi.get_dmi_ptr(), (unsigned char*)400);
 }
+
+class exmon_harness : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    generic::memory mem;
+
+    size_t invalidations;
+
+    exmon_harness(const sc_module_name& nm):
+        test_base(nm), out("out"), mem("mem", 0x1000), invalidations(0) {
+        out.bind(mem.in);
+        clk.bind(mem.clk);
+        rst.bind(mem.rst);
+    }
+
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override {
+        test_base::invalidate_direct_mem_ptr(origin, start, end);
+        invalidations++;
+    }
+
+    virtual void run_test() override {
+        const tlm_sbi excl = SBI_EXCL | sbi_cpuid(0);
+
+        u32 val = 0;
+        ASSERT_OK(out.writew<u32>(0x10, 0));
+        ASSERT_NE(out.lookup_dmi_ptr(0x10, 4), nullptr);
+
+        // the load punches the lock out of all dmi maps, but nobody asked
+        // for dmi while it was held, so its release stays silent
+        ASSERT_OK(out.readw(0x10, val, excl));
+        EXPECT_EQ(invalidations, 1);
+        ASSERT_OK(out.writew<u32>(0x10, 1, excl));
+        EXPECT_EQ(invalidations, 1);
+        EXPECT_FALSE(mem.in.exmon().has_locks());
+
+        // a dmi grant shrunk around the lock is widened again on release
+        ASSERT_OK(out.readw(0x10, val, excl));
+        EXPECT_EQ(invalidations, 2);
+        out.unmap_dmi(0, 0xfff);
+        ASSERT_OK(out.readw(0x100, val));
+        EXPECT_NE(out.lookup_dmi_ptr(0x100, 4), nullptr);
+        EXPECT_EQ(out.lookup_dmi_ptr(0x10, 4), nullptr);
+        ASSERT_OK(out.writew<u32>(0x10, 2, excl));
+        EXPECT_EQ(invalidations, 3);
+
+        ASSERT_OK(out.readw(0x10, val));
+        EXPECT_EQ(val, 2);
+        EXPECT_NE(out.lookup_dmi_ptr(0x10, 4), nullptr);
+        EXPECT_EQ(invalidations, 3);
+    }
+};
+
+TEST(tlm_exmon, invalidations) {
+    exmon_harness harness("harness");
+    sc_core::sc_start();
+}
@@ -19,6 +19,36 @@ TEST(gpio, to_string) {
     std::cout << tx << std::endl;
 }
 
+TEST(gpio, state) {
+    gpio_state state;
+    EXPECT_FALSE(state.read(GPIO_NO_VECTOR));
+    EXPECT_TRUE(state.write(GPIO_NO_VECTOR, true));
+    EXPECT_FALSE(state.write(GPIO_NO_VECTOR, true));
+    EXPECT_TRUE(state.read(GPIO_NO_VECTOR));
+
+    EXPECT_TRUE(state.write(65, true));
+    EXPECT_TRUE(state.read(65));
+    EXPECT_EQ(state.read_mask(64), 0x2u);
+    EXPECT_EQ(state.read_mask(60), 0x20u);
+
+    EXPECT_EQ(state.write_mask(64, 0xf, 0x5), 0x7u);
+    EXPECT_EQ(state.read_mask(64), 0x5u);
+    EXPECT_EQ(state.write_mask(64, 0xf, 0x5), 0x0u);
+
+    gpio_vector sparse = gpio_state::DENSE_LIMIT + 7;
+    EXPECT_TRUE(state.write(sparse, true));
+    EXPECT_EQ(state.read_mask(sparse - 1), 0x2u);
+    EXPECT_EQ(state.write_mask(sparse, 0x3, 0x2), 0x3u);
+    EXPECT_FALSE(state.read(sparse));
+    EXPECT_TRUE(state.read(sparse + 1));
+
+    // vectors past the end of the range must not alias GPIO_NO_VECTOR
+    gpio_vector last = GPIO_NO_VECTOR - 2;
+    EXPECT_EQ(state.write_mask(last, 0xf, 0x3), 0x3u);
+    EXPECT_EQ(state.read_mask(last), 0x3u);
+    EXPECT_TRUE(state.read(GPIO_NO_VECTOR));
+}
+
 MATCHER_P(gpio, name, "Matches a gpio socket by name") {
     return strcmp(arg.basename(), name) == 0;
 }
@@ -68,6 +98,13 @@ public:
         EXPECT_TRUE(out2.is_stubbed());
         EXPECT_TRUE(in[2].is_stubbed());
 
+        // check socket indexing
+        EXPECT_EQ(in.index_of(in[2]), 2u);
+        EXPECT_EQ(in[2].index(), 2u);
+        EXPECT_TRUE(in.contains(in[1]));
+        EXPECT_FALSE(in.contains(a_in));
+        EXPECT_EQ(a_in.index(), SIZE_MAX);
+
         // check adapters
         a_out.bind(signal);
         a_in.bind(signal);
@@ -138,6 +175,24 @@ public:
         EXPECT_FALSE(in[0]);
         EXPECT_FALSE(in[1]);
 
+        // test bulk updates
+        const gpio_vector v1 = 1, v3 = 3;
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), true, v1));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), true, v3));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), true, v1));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), true, v3));
+        out.write_mask(0xf, 0xa);
+        out.write_mask(0xf, 0xa); // should not trigger a second time
+        EXPECT_EQ(out.read_mask(), 0xau);
+        EXPECT_EQ(in[0].read_mask(), 0xau);
+        EXPECT_EQ(in[1].read_mask(), 0xau);
+        EXPECT_TRUE(in[0][v3]);
+
+        EXPECT_CALL(*this, gpio_notify(gpio("in[0]"), false, v1));
+        EXPECT_CALL(*this, gpio_notify(gpio("in[1]"), false, v1));
+        out.write_mask(0x2, 0x0);
+        EXPECT_EQ(in[0].read_mask(), 0x8u);
+
         // test adapters
         EXPECT_CALL(*this, gpio_notify(gpio("a_in"), true, GPIO_NO_VECTOR));
         a_out.raise();
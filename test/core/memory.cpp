@@ -112,3 +112,27 @@ TEST(memory, sharing_wrong_size) {
     EXPECT_DEATH({ tlm_memory b(name, size * 2); }, "unexpected size");
     EXPECT_DEATH({ tlm_memory b(name, size / 2); }, "unexpected size");
 }
+
+TEST(memory, unshare) {
+    const size_t size = 16 * KiB;
+    const string name = "/vcml-test-unshare";
+    tlm_memory a(name, size);
+    tlm_memory b(name, size);
+
+    a[0] = 0x11;
+    u8* data = b.data();
+    b.unshare();
+
+    EXPECT_FALSE(b.is_shared());
+    EXPECT_EQ(b.data(), data) << "unsharing moved the memory";
+    EXPECT_EQ(b[0], 0x11) << "contents lost while unsharing";
+
+    a[0] = 0x22;
+    b[1] = 0x33;
+    EXPECT_EQ(b[0], 0x11) << "private copy sees shared writes";
+    EXPECT_EQ(a[1], 0) << "shared memory sees private writes";
+
+    size_t offset = 0;
+    EXPECT_EQ(tlm_memory::find_shared(b.data(), offset), nullptr);
+    EXPECT_EQ(tlm_memory::find_shared(a.data(), offset), &a);
+}
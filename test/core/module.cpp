@@ -77,3 +77,9 @@ TEST(module, local_processes) {
     ASSERT_EQ(mod.thread_calls, 1);
     ASSERT_EQ(mod.method_calls, 1);
 }
+
+TEST(module, fork_expand) {
+    EXPECT_EQ(vcml::module::fork_expand("tcp:500{fork}", 3), "tcp:5003");
+    EXPECT_EQ(vcml::module::fork_expand("{fork}/{fork}.img", 12), "12/12.img");
+    EXPECT_EQ(vcml::module::fork_expand("stdout", 1), "stdout");
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+TEST(mpsc, basic) {
+    mpsc_queue<int, 4> queue;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+    EXPECT_TRUE(queue.push(4));
+    EXPECT_FALSE(queue.push(5));
+    EXPECT_FALSE(queue.empty());
+
+    int val = 0;
+    EXPECT_TRUE(queue.pop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_TRUE(queue.push(5));
+
+    vector<int> vals;
+    EXPECT_EQ(queue.drain([&](int v) { vals.push_back(v); }, 2), 2u);
+    EXPECT_EQ(vals, vector<int>({ 2, 3 }));
+    EXPECT_EQ(queue.drain([&](int v) { vals.push_back(v); }), 2u);
+    EXPECT_EQ(vals, vector<int>({ 2, 3, 4, 5 }));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(val));
+}
+
+TEST(mpsc, threads) {
+    const size_t nthreads = 4;
+    const size_t count = 10000;
+
+    mpsc_queue<size_t, 64> queue;
+    vector<thread> producers;
+    for (size_t t = 0; t < nthreads; t++) {
+        producers.emplace_back([&queue, t, count]() {
+            for (size_t i = 0; i < count; i++) {
+                while (!queue.push(t * count + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    vector<size_t> next(nthreads, 0);
+    size_t received = 0;
+    while (received < nthreads * count) {
+        size_t val;
+        if (!queue.pop(val))
+            continue;
+
+        // entries from a single producer must arrive in order
+        size_t t = val / count;
+        ASSERT_LT(t, nthreads);
+        EXPECT_EQ(val % count, next[t]++);
+        received++;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(mpsc, recycle) {
+    mpsc_queue<vector<int>, 2> queue;
+    EXPECT_TRUE(queue.emplace([](vector<int>& v) { v.assign({ 1, 2, 3 }); }));
+    EXPECT_TRUE(queue.emplace([](vector<int>& v) { v.assign({ 4 }); }));
+    EXPECT_FALSE(queue.emplace([](vector<int>& v) { v.clear(); }));
+
+    vector<int> val;
+    val.reserve(100);
+    const int* storage = val.data();
+
+    // the buffer of val is handed to the queue instead of being freed
+    EXPECT_TRUE(queue.exchange(val));
+    EXPECT_EQ(val, vector<int>({ 1, 2, 3 }));
+    EXPECT_TRUE(queue.emplace([&](vector<int>& v) {
+        EXPECT_EQ(v.data(), storage);
+        EXPECT_GE(v.capacity(), 100u);
+        v.assign({ 5, 6 });
+    }));
+
+    EXPECT_TRUE(queue.exchange(val));
+    EXPECT_EQ(val, vector<int>({ 4 }));
+    EXPECT_TRUE(queue.exchange(val));
+    EXPECT_EQ(val, vector<int>({ 5, 6 }));
+    EXPECT_EQ(val.data(), storage);
+    EXPECT_FALSE(queue.exchange(val));
+    EXPECT_TRUE(queue.empty());
+}
@@ -54,6 +54,33 @@ public:
         queue.wait(val);
         EXPECT_EQ(val, 6);
         EXPECT_EQ(sc_time_stamp(), sc_time(5.0, SC_SEC));
+
+        queue.notify(7, 1.0, SC_SEC);
+        queue.notify(7, 2.0, SC_SEC);
+        queue.notify(8, 3.0, SC_SEC);
+        queue.notify(9, 3.0, SC_SEC);
+        queue.cancel(7);
+
+        queue.wait(val);
+        EXPECT_EQ(val, 8);
+        EXPECT_EQ(sc_time_stamp(), sc_time(8.0, SC_SEC));
+
+        queue.wait(val);
+        EXPECT_EQ(val, 9);
+        EXPECT_EQ(sc_time_stamp(), sc_time(8.0, SC_SEC));
+        EXPECT_EQ(queue.size(), 0);
+
+        // cancelled notifications must not linger until their deadline
+        queue.notify(10, 1.0, SC_SEC);
+        for (int i = 0; i < 1000; i++) {
+            queue.notify(i + 100, (double)(i % 7) + 2.0, SC_SEC);
+            queue.cancel(i + 100);
+        }
+
+        EXPECT_EQ(queue.size(), 1);
+        queue.wait(val);
+        EXPECT_EQ(val, 10);
+        EXPECT_EQ(sc_time_stamp(), sc_time(9.0, SC_SEC));
     }
 };
 
@@ -17,10 +17,50 @@ using namespace ::testing;
 
 const vcml::hz_t DEFCLK = 1 * vcml::kHz;
 
+class mock_memory : public vcml::peripheral
+{
+public:
+    vcml::u8 mem[0x1000];
+    size_t reads;
+
+    vcml::tlm_target_socket insn_in;
+    vcml::tlm_target_socket data_in;
+
+    mock_memory(const sc_core::sc_module_name& nm):
+        vcml::peripheral(nm),
+        mem(),
+        reads(0),
+        insn_in("insn_in"),
+        data_in("data_in") {
+        for (size_t i = 0; i < sizeof(mem); i++)
+            mem[i] = (vcml::u8)i;
+    }
+
+    virtual tlm::tlm_response_status read(const vcml::range& addr, void* data,
+                                          const vcml::tlm_sbi& info) override {
+        if (!info.is_debug)
+            reads++;
+        memcpy(data, mem + addr.start, addr.length());
+        return tlm::TLM_OK_RESPONSE;
+    }
+
+    virtual tlm::tlm_response_status write(const vcml::range& addr,
+                                           const void* data,
+                                           const vcml::tlm_sbi& info) override {
+        memcpy(mem + addr.start, data, addr.length());
+        return tlm::TLM_OK_RESPONSE;
+    }
+};
+
 class mock_processor : public vcml::processor
 {
 public:
     vcml::u64 cycles;
+    std::function<void(void)> hook;
+
+    bool idle;   // reported to processor::can_skip_idle
+    bool halted; // simulate does not execute any cycles while halted
+    std::vector<std::pair<sc_core::sc_time, vcml::u64>> runs;
 
     vcml::gpio_initiator_socket rst_out;
     vcml::clk_initiator_socket clk_out;
@@ -37,6 +77,10 @@ public:
     mock_processor(const sc_core::sc_module_name& nm):
         vcml::processor(nm, "mock"),
         cycles(0),
+        hook(),
+        idle(false),
+        halted(false),
+        runs(),
         rst_out("rst_out"),
         clk_out("clk_out"),
         irq0("irq0"),
@@ -49,18 +93,67 @@ public:
     }
 
     virtual vcml::u64 cycle_count() const override { return cycles; }
+    virtual bool is_idle() const override { return idle; }
 
     virtual void simulate(size_t n) override {
         const sc_core::sc_time& now = sc_core::sc_time_stamp();
         ASSERT_EQ(local_time_stamp(), now);
 
+        if (hook) {
+            auto fn = std::move(hook);
+            hook = nullptr;
+            fn();
+        }
+
         simulate2(n);
-        cycles += n;
 
-        ASSERT_EQ(local_time(), clock_cycles(n));
+        size_t done = halted ? 0 : n;
+        runs.emplace_back(now, done);
+        cycles += done;
+
+        ASSERT_EQ(local_time(), clock_cycles(done));
+    }
+
+    virtual void end_of_elaboration() override {
+        clk_out = DEFCLK;
+        rst_out.pulse();
+    }
+};
+
+class profiled_processor : public vcml::processor
+{
+public:
+    vcml::u64 cycles;
+
+    vcml::gpio_initiator_socket rst_out;
+    vcml::clk_initiator_socket clk_out;
+
+    profiled_processor(const sc_core::sc_module_name& nm):
+        vcml::processor(nm, "mock"),
+        cycles(0),
+        rst_out("rst_out"),
+        clk_out("clk_out") {
+        clk_out.bind(clk);
+        rst_out.bind(rst);
+        insn.stub();
+        data.stub();
+    }
+
+    virtual ~profiled_processor() {
+        // nothing to do
     }
 
+    virtual vcml::u64 cycle_count() const override { return cycles; }
+
+    // cycles through four program counters every 100 cycles
+    virtual vcml::u64 program_counter() override {
+        return (cycles / 100) % 4 * 4;
+    }
+
+    virtual void simulate(size_t n) override { cycles += n; }
+
     virtual void end_of_elaboration() override {
+        vcml::processor::end_of_elaboration();
         clk_out = DEFCLK;
         rst_out.pulse();
     }
@@ -84,6 +177,115 @@ TEST(processor, processor) {
     cpu.irq[0].bind(cpu.irq0);
     cpu.irq[1].bind(cpu.irq1);
 
+    vcml::broker broker("test");
+    broker.define("FCPU.fetch_cache", true);
+    broker.define("FCPU.fetch_cache_lines", 4);
+    broker.define("ICPU.idle_limit", "250ms");
+    broker.define("NCPU.idle_skip", false);
+
+    std::string profile = vcml::mkstr("/tmp/vcml_profile_test_%d",
+                                      (int)mwr::getpid());
+    std::string qprofile = profile + "_q";
+    broker.define("PCPU.profile", profile);
+    broker.define("PCPU.profile_interval", 100);
+    broker.define("QCPU.profile", qprofile);
+    broker.define("QCPU.profile_period", "50ms");
+
+    profiled_processor pcpu("PCPU");
+    profiled_processor qcpu("QCPU");
+
+    NiceMock<mock_processor> icpu("ICPU");
+    icpu.clk_out.bind(icpu.clk);
+    icpu.rst_out.bind(icpu.rst);
+    icpu.insn.stub();
+    icpu.data.stub();
+    icpu.irq[0].bind(icpu.irq0);
+    icpu.irq[1].bind(icpu.irq1);
+    icpu.idle = icpu.halted = true;
+    ON_CALL(icpu, interrupt(0, true)).WillByDefault(Invoke([&](size_t, bool) {
+        icpu.idle = icpu.halted = false;
+    }));
+
+    NiceMock<mock_processor> ncpu("NCPU");
+    ncpu.clk_out.bind(ncpu.clk);
+    ncpu.rst_out.bind(ncpu.rst);
+    ncpu.insn.stub();
+    ncpu.data.stub();
+    ncpu.irq[0].bind(ncpu.irq0);
+    ncpu.irq[1].bind(ncpu.irq1);
+    ncpu.idle = true;
+
+    NiceMock<mock_processor> fcpu("FCPU");
+    mock_memory fmem("FMEM");
+    fcpu.clk_out.bind(fcpu.clk);
+    fcpu.rst_out.bind(fcpu.rst);
+    fcpu.clk_out.bind(fmem.clk);
+    fcpu.rst_out.bind(fmem.rst);
+    fcpu.insn.bind(fmem.insn_in);
+    fcpu.data.bind(fmem.data_in);
+    fcpu.irq[0].bind(fcpu.irq0);
+    fcpu.irq[1].bind(fcpu.irq1);
+
+    // test processor::fetch with the fetch cache enabled
+    bool fetched = false;
+    vcml::u8 dmimem[0x100];
+    memset(dmimem, 0xab, sizeof(dmimem));
+    fcpu.hook = [&]() {
+        vcml::u32 val = 0;
+
+        // first fetch fills the whole line, later fetches hit
+        EXPECT_EQ(fcpu.fetch(0x100, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0x03020100u);
+        EXPECT_EQ(fmem.reads, 1);
+        EXPECT_EQ(fcpu.fetch(0x13c, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0x3f3e3d3cu);
+        EXPECT_EQ(fmem.reads, 1);
+        EXPECT_EQ(fcpu.fetch(0x140, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0x43424140u);
+        EXPECT_EQ(fmem.reads, 2);
+
+        // data writes must flush stale lines
+        EXPECT_EQ(fcpu.write(0x104, 0xdeadbeefu), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(fcpu.fetch(0x104, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0xdeadbeefu);
+        EXPECT_EQ(fmem.reads, 3);
+
+        // debug writes must flush stale lines
+        vcml::u32 dbg = 0x12345678;
+        vcml::debugging::target& tgt = fcpu;
+        EXPECT_EQ(tgt.write_pmem_dbg(0x108, &dbg, sizeof(dbg)), sizeof(dbg));
+        EXPECT_EQ(fcpu.fetch(0x108, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, dbg);
+        EXPECT_EQ(fmem.reads, 4);
+
+        // dmi invalidation must flush the affected lines
+        EXPECT_EQ(fcpu.fetch(0x100, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(fmem.reads, 4);
+        fcpu.insn.invalidate_direct_mem_ptr(0x100, 0x13f);
+        EXPECT_EQ(fcpu.fetch(0x100, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0x03020100u);
+        EXPECT_EQ(fmem.reads, 5);
+        EXPECT_EQ(fcpu.fetch(0x140, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(fmem.reads, 5);
+
+        // regions with dmi bypass the fetch cache
+        tlm::tlm_dmi dmi;
+        dmi.set_dmi_ptr(dmimem);
+        dmi.set_start_address(0x200);
+        dmi.set_end_address(0x2ff);
+        dmi.set_granted_access(tlm::tlm_dmi::DMI_ACCESS_READ_WRITE);
+        fcpu.insn.dmi_cache().insert(dmi);
+        EXPECT_EQ(fcpu.fetch(0x200, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0xababababu);
+        EXPECT_EQ(fmem.reads, 5);
+        fcpu.insn.unmap_dmi(0x200, 0x2ff);
+        EXPECT_EQ(fcpu.fetch(0x200, val), tlm::TLM_OK_RESPONSE);
+        EXPECT_EQ(val, 0x03020100u);
+        EXPECT_EQ(fmem.reads, 6);
+
+        fetched = true;
+    };
+
     // finish elaboration
     EXPECT_CALL(cpu, reset()).Times(1);
     EXPECT_CALL(cpu, handle_clock_update(0, DEFCLK)).Times(1);
@@ -100,6 +302,10 @@ TEST(processor, processor) {
     EXPECT_CALL(cpu, simulate2(quantum / cycle)).Times(10);
     sc_core::sc_start(10 * quantum);
 
+    // test processor::skip_idle, wake up the idle processor via interrupt
+    sc_core::sc_time wake = sc_core::sc_time_stamp();
+    icpu.irq0 = true;
+
     // test processor::interrupt
     EXPECT_CALL(cpu, interrupt(0, true)).Times(1);
     cpu.irq0 = true;
@@ -151,4 +357,68 @@ TEST(processor, processor) {
     EXPECT_CALL(cpu, handle_clock_update(0, DEFCLK)).Times(1);
     cpu.clk_out = DEFCLK;
     sc_core::sc_start(10 * quantum);
+
+    EXPECT_TRUE(fetched) << "fetch cache test did not run";
+
+    // idle processors skip ahead, but never further than idle_limit
+    sc_core::sc_time limit = icpu.idle_limit.get();
+    EXPECT_EQ(limit, sc_core::sc_time(250, sc_core::SC_MS));
+    sc_core::sc_time longest = sc_core::SC_ZERO_TIME;
+    ASSERT_FALSE(icpu.runs.empty());
+    for (size_t i = 1; i < icpu.runs.size(); i++) {
+        if (icpu.runs[i - 1].second > 0)
+            continue;
+        sc_core::sc_time skip = icpu.runs[i].first - icpu.runs[i - 1].first;
+        EXPECT_LE(skip, limit);
+        longest = std::max(longest, skip);
+    }
+
+    EXPECT_EQ(longest, limit);
+    EXPECT_EQ(icpu.get_idle_time(), wake);
+
+    // the interrupt must end idle skipping right away
+    auto it = std::find_if(icpu.runs.begin(), icpu.runs.end(),
+                           [](const auto& run) { return run.second > 0; });
+    ASSERT_NE(it, icpu.runs.end()) << "processor did not wake up";
+    EXPECT_EQ(it->first, wake);
+
+    // test processor::simulate_profiled, one sample per profile interval
+    ASSERT_GT(pcpu.cycles, 0u);
+    ASSERT_GT(qcpu.cycles, 0u);
+    EXPECT_EQ(pcpu.profile_samples(), (pcpu.cycles + 99) / 100);
+    EXPECT_EQ(qcpu.profile_samples(), (qcpu.cycles + 49) / 50);
+
+    std::stringstream ss;
+    EXPECT_TRUE(pcpu.execute("profile", { profile }, ss));
+    EXPECT_EQ(ss.str(), vcml::mkstr("written %zu samples to %s",
+                                    pcpu.profile_samples(), profile.c_str()));
+
+    std::ifstream folded(profile);
+    EXPECT_TRUE(folded.good()) << "profile not written";
+
+    std::string frame;
+    size_t count = 0, frames = 0, total = 0;
+    while (folded >> frame >> count) {
+        EXPECT_EQ(frame, vcml::mkstr("0x%016llx", frames * 4ull));
+        total += count;
+        frames++;
+    }
+
+    EXPECT_EQ(frames, 4);
+    EXPECT_EQ(total, pcpu.profile_samples());
+
+    // the simulation never ends here, so make sure no profile gets written
+    // once it gets torn down after the files have been removed
+    pcpu.profile.set("");
+    qcpu.profile.set("");
+    std::remove(profile.c_str());
+    std::remove(qprofile.c_str());
+
+    // without idle_skip, idle processors keep simulating every cycle
+    EXPECT_EQ(ncpu.get_idle_time(), sc_core::SC_ZERO_TIME);
+    ASSERT_FALSE(ncpu.runs.empty());
+    for (size_t i = 1; i < ncpu.runs.size(); i++) {
+        const auto& prev = ncpu.runs[i - 1];
+        EXPECT_EQ(ncpu.runs[i].first, prev.first + cycle * (double)prev.second);
+    }
 }
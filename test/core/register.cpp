@@ -161,6 +161,63 @@ TEST(registers, read_byte_enable) {
     EXPECT_TRUE(tx.is_response_ok());
 }
 
+TEST(registers, read_byte_enable_clear_on_read) {
+    mock_peripheral mock;
+    tlm::tlm_generic_payload tx;
+
+    // test_reg_b acts as a read-to-clear register
+    u32 status = 0xabcd1234;
+    ON_CALL(mock, reg_read()).WillByDefault(Invoke([&]() -> u32 {
+        u32 val = status;
+        status = 0;
+        return val;
+    }));
+
+    unsigned char buffer[8] = {};
+    unsigned char bebuff[] = {
+        0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+    };
+
+    // reading only the lanes of test_reg_a must not touch test_reg_b
+    mock.test_reg_a = 0x11223344;
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0, buffer, sizeof(buffer));
+    tx.set_byte_enable_ptr(bebuff);
+    tx.set_byte_enable_length(sizeof(bebuff));
+
+    EXPECT_CALL(mock, reg_read()).Times(0);
+    EXPECT_EQ(mock.test_transport(tx), 4);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(status, 0xabcd1234u);
+    EXPECT_EQ(buffer[0], 0x44);
+    EXPECT_EQ(buffer[3], 0x11);
+    EXPECT_EQ(buffer[4], 0x00);
+    Mock::VerifyAndClearExpectations(&mock);
+
+    // a fully disabled access must not trigger the callback either
+    unsigned char nobuff[] = { 0x00, 0x00, 0x00, 0x00 };
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 4, buffer, 4);
+    tx.set_byte_enable_ptr(nobuff);
+    tx.set_byte_enable_length(sizeof(nobuff));
+
+    EXPECT_CALL(mock, reg_read()).Times(0);
+    EXPECT_EQ(mock.test_transport(tx), 0);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(status, 0xabcd1234u);
+    Mock::VerifyAndClearExpectations(&mock);
+
+    // enabling a single lane reads and clears the register once
+    unsigned char onebuff[] = { 0x00, 0xff, 0x00, 0x00 };
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 4, buffer, 4);
+    tx.set_byte_enable_ptr(onebuff);
+    tx.set_byte_enable_length(sizeof(onebuff));
+
+    EXPECT_CALL(mock, reg_read()).Times(1);
+    EXPECT_EQ(mock.test_transport(tx), 1);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(buffer[1], 0x12);
+    EXPECT_EQ(status, 0u);
+}
+
 TEST(registers, write_byte_enable) {
     mock_peripheral mock;
     sc_core::sc_time cycle(1.0 / mock.clk, sc_core::SC_SEC);
@@ -183,6 +240,25 @@ TEST(registers, write_byte_enable) {
     EXPECT_TRUE(tx.is_response_ok());
 }
 
+TEST(registers, write_byte_enable_callback) {
+    mock_peripheral mock;
+    tlm::tlm_generic_payload tx;
+
+    unsigned char buffer[] = { 0x11, 0x22, 0x33, 0x44 };
+    unsigned char bebuff[] = { 0xff, 0x00, 0xff, 0x00 };
+
+    tx_setup(tx, tlm::TLM_WRITE_COMMAND, 4, buffer, sizeof(buffer));
+    tx.set_byte_enable_ptr(bebuff);
+    tx.set_byte_enable_length(sizeof(bebuff));
+
+    // strobed writes must be merged and reported with a single callback
+    EXPECT_CALL(mock, reg_write(0xff33ff11)).Times(1);
+    EXPECT_EQ(mock.test_transport(tx), 2);
+    EXPECT_EQ(tx.get_byte_enable_ptr(), bebuff);
+    EXPECT_EQ(tx.get_streaming_width(), sizeof(buffer));
+    EXPECT_TRUE(tx.is_response_ok());
+}
+
 TEST(registers, permissions) {
     mock_peripheral mock;
 
@@ -703,3 +779,123 @@ TEST(registers, peripheral_cmd_mmap) {
     mock.execute("mmap", { "111" }, std::cout);
     std::cout << std::endl;
 }
+
+class regmap_peripheral : public peripheral
+{
+public:
+    size_t ctrl_writes;
+
+    u32 read_status() { return 0xabcd1234; }
+    void write_ctrl(u32 val) {
+        ctrl_writes++;
+        regs.get<CTRL>() = val & 0xff;
+    }
+
+    using CTRL = regdef<0x0, u32, VCML_ACCESS_READ_WRITE, 0x11, nullptr,
+                        &regmap_peripheral::write_ctrl>;
+    using STATUS = regdef<0x4, u32, VCML_ACCESS_READ, 0,
+                          &regmap_peripheral::read_status>;
+    using DATA = regdef<0xc, u16>;
+
+    regmap<regmap_peripheral, CTRL, STATUS, DATA> regs;
+
+    regmap_peripheral(const sc_core::sc_module_name& nm =
+                          sc_core::sc_gen_unique_name("regmap_peripheral")):
+        peripheral(nm, ENDIAN_LITTLE),
+        ctrl_writes(0),
+        regs("regs", 0x100, { "CTRL", "STATUS", "DATA" }) {
+        clk.stub(100 * MHz);
+        rst.stub();
+    }
+
+    unsigned int test_transport(tlm::tlm_generic_payload& tx) {
+        return transport(tx, SBI_NONE, VCML_AS_DEFAULT);
+    }
+};
+
+TEST(registers, regmap) {
+    regmap_peripheral mock;
+    tlm::tlm_generic_payload tx;
+    u32 data[3] = {};
+
+    EXPECT_EQ(mock.regs.get_range(), range(0x100, 0x10d));
+    EXPECT_EQ(mock.regs.get<regmap_peripheral::CTRL>(), 0x11u);
+    EXPECT_STREQ(mock.regs.prop<regmap_peripheral::DATA>().basename(), "DATA");
+
+    data[0] = 0x1234;
+    tx_setup(tx, tlm::TLM_WRITE_COMMAND, 0x100, data, 4);
+    EXPECT_EQ(mock.test_transport(tx), 4);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(mock.ctrl_writes, 1);
+    EXPECT_EQ(mock.regs.get<regmap_peripheral::CTRL>(), 0x34u);
+
+    tx_setup(tx, tlm::TLM_WRITE_COMMAND, 0x104, data, 4);
+    EXPECT_EQ(mock.test_transport(tx), 0);
+    EXPECT_EQ(tx.get_response_status(), tlm::TLM_COMMAND_ERROR_RESPONSE);
+
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0x108, data, 4);
+    EXPECT_EQ(mock.test_transport(tx), 0);
+    EXPECT_EQ(tx.get_response_status(), tlm::TLM_ADDRESS_ERROR_RESPONSE);
+
+    data[2] = 0xffffffff;
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0x100, data, 12);
+    EXPECT_EQ(mock.test_transport(tx), 12);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(data[0], 0x34u);
+    EXPECT_EQ(data[1], 0xabcd1234u);
+    EXPECT_EQ(data[2], 0u);
+
+    mock.reset();
+    EXPECT_EQ(mock.regs.get<regmap_peripheral::CTRL>(), 0x11u);
+}
+
+class timed_peripheral : public peripheral
+{
+public:
+    reg<u64> counter;
+    reg<u32, 2> stamps;
+
+    u64 read_counter(const sc_time& t) { return t / clock_cycle(); }
+    u32 read_stamp(size_t idx, const sc_time& t) {
+        return idx + time_to_us(t);
+    }
+
+    timed_peripheral(const sc_core::sc_module_name& nm =
+                         sc_core::sc_gen_unique_name("timed_peripheral")):
+        peripheral(nm, ENDIAN_LITTLE, 2, 0),
+        counter("counter", 0x0),
+        stamps("stamps", 0x8) {
+        counter.on_read(&timed_peripheral::read_counter);
+        stamps.on_read(&timed_peripheral::read_stamp);
+        clk.stub(100 * MHz);
+        rst.stub();
+        handle_clock_update(0, clk.read());
+    }
+
+    unsigned int test_transport(tlm::tlm_generic_payload& tx) {
+        return transport(tx, SBI_NONE, VCML_AS_DEFAULT);
+    }
+};
+
+TEST(registers, read_local_time) {
+    timed_peripheral mock;
+    sc_core::sc_time& local = mock.local_time();
+    tlm::tlm_generic_payload tx;
+    u64 data = 0;
+
+    // callbacks see the local time including the read latency
+    local = mock.clock_cycles(40);
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0x0, &data, sizeof(data));
+    EXPECT_EQ(mock.test_transport(tx), 8);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(data, 42u);
+    EXPECT_EQ(local, mock.clock_cycles(42));
+
+    u32 stamps[2] = {};
+    local = sc_core::sc_time(7.0, sc_core::SC_US);
+    tx_setup(tx, tlm::TLM_READ_COMMAND, 0x8, stamps, sizeof(stamps));
+    EXPECT_EQ(mock.test_transport(tx), 8);
+    EXPECT_TRUE(tx.is_response_ok());
+    EXPECT_EQ(stamps[0], 7u);
+    EXPECT_EQ(stamps[1], 8u);
+}
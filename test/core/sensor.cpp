@@ -0,0 +1,69 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class sensor_test : public test_base
+{
+public:
+    sensor temp;
+
+    sensor_test(const sc_module_name& nm): test_base(nm), temp("temp", 20.0) {}
+    virtual ~sensor_test() = default;
+
+    virtual void run_test() override {
+        EXPECT_STREQ(temp.kind(), "vcml::sensor");
+        EXPECT_EQ(temp.value(), 20.0);
+        EXPECT_TRUE(temp.is_static());
+        EXPECT_EQ(temp.time_to(30.0), SC_MAX_TIME);
+
+        temp.ramp(30.0, 1.0);
+        EXPECT_FALSE(temp.is_static());
+        EXPECT_EQ(temp.time_to(10.0), SC_MAX_TIME);
+        EXPECT_EQ(temp.time_to(40.0), SC_MAX_TIME);
+
+        wait(5.0, SC_SEC);
+        EXPECT_DOUBLE_EQ(temp.value(), 25.0);
+        EXPECT_GT(temp.time_to(28.0), sc_time(3.0, SC_SEC));
+        EXPECT_LT(temp.time_to(28.0), sc_time(3.1, SC_SEC));
+
+        // crossings are reported once, right after passing the threshold
+        temp.watch({ 28.0, 40.0 });
+        wait(temp.event());
+        EXPECT_GT(temp.value(), 28.0);
+        EXPECT_NEAR(sc_time_stamp().to_seconds(), 8.0, 1e-9);
+
+        wait(10.0, SC_SEC);
+        EXPECT_EQ(temp.value(), 30.0);
+        EXPECT_TRUE(temp.is_static());
+
+        // ramping down and jumping
+        temp.ramp(0.0, 10.0);
+        temp.watch({ 15.0 });
+        wait(temp.event());
+        EXPECT_LT(temp.value(), 15.0);
+        EXPECT_NEAR(sc_time_stamp().to_seconds(), 19.5, 1e-9);
+
+        sc_time now = sc_time_stamp();
+        temp.set(50.0);
+        wait(temp.event());
+        EXPECT_EQ(sc_time_stamp(), now);
+        EXPECT_EQ(temp.value(), 50.0);
+        EXPECT_TRUE(temp.is_static());
+
+        temp.unwatch();
+        EXPECT_EQ(temp.value_at(now + sc_time(1.0, SC_SEC)), 50.0);
+    }
+};
+
+TEST(sensor, simulate) {
+    sensor_test test("test");
+    sc_core::sc_start();
+}
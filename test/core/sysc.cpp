@@ -80,4 +80,14 @@ TEST(systemc, callback) {
 
     sc_core::sc_start(10, SC_SEC);
     EXPECT_TRUE(update_called);
+
+    // callbacks beyond the queue capacity must still run in order
+    vector<size_t> order;
+    for (size_t i = 0; i < 3000; i++)
+        on_next_update([&order, i]() -> void { order.push_back(i); });
+
+    sc_core::sc_start(10, SC_SEC);
+    ASSERT_EQ(order.size(), 3000u);
+    for (size_t i = 0; i < order.size(); i++)
+        ASSERT_EQ(order[i], i);
 }
@@ -80,3 +80,85 @@ TEST(tlm, base_sockets) {
     tlm_harness test("tlm");
     sc_core::sc_start();
 }
+
+class tlm_vectored_harness : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    tlm_initiator_socket mem_out;
+    generic::memory mem;
+
+    u8 buffer[64];
+
+    tlm_vectored_harness(const sc_module_name& nm):
+        test_base(nm),
+        out("out"),
+        in("in"),
+        mem_out("mem_out"),
+        mem("mem", 0x1000),
+        buffer() {
+        out.bind(in);
+        mem_out.bind(mem.in);
+        clk.bind(mem.clk);
+        rst.bind(mem.rst);
+    }
+
+    virtual ~tlm_vectored_harness() = default;
+
+    MOCK_METHOD(void, receive, (u64, unsigned int));
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        receive(tx.get_address(), tx.get_data_length());
+        u8* ptr = buffer + tx.get_address();
+        if (tx.is_read())
+            memcpy(tx.get_data_ptr(), ptr, tx.get_data_length());
+        if (tx.is_write())
+            memcpy(ptr, tx.get_data_ptr(), tx.get_data_length());
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    virtual void run_test() override {
+        u8 a[4] = { 1, 2, 3, 4 };
+        u8 b[2] = { 5, 6 };
+        u8 c[3] = { 7, 8, 9 };
+
+        // adjacent segments are coalesced into a single transaction
+        vector<tlm_segment> segs = { { 0, a, 4 }, { 4, b, 2 }, { 16, c, 3 } };
+        unsigned int n = 0;
+        EXPECT_CALL(*this, receive(0, 6));
+        EXPECT_CALL(*this, receive(16, 3));
+        EXPECT_OK(out.writev(segs, SBI_NONE, &n));
+        EXPECT_EQ(n, 9);
+        EXPECT_EQ(buffer[3], 4);
+        EXPECT_EQ(buffer[4], 5);
+        EXPECT_EQ(buffer[18], 9);
+
+        u8 x[3] = {}, y[3] = {};
+        segs = { { 2, x, 3 }, { 5, y, 3 } };
+        EXPECT_CALL(*this, receive(2, 6));
+        EXPECT_OK(out.readv(segs));
+        EXPECT_EQ(x[0], 3);
+        EXPECT_EQ(y[0], 6);
+        EXPECT_EQ(y[2], 0);
+
+        // once dmi has been granted, segments are copied directly
+        EXPECT_OK(mem_out.writew<u32>(0, 0));
+        EXPECT_NE(mem_out.lookup_dmi_ptr(0, 4), nullptr);
+        segs = { { 0x100, a, 4 }, { 0x104, b, 2 }, { 0x200, c, 3 } };
+        EXPECT_OK(mem_out.writev(segs, SBI_NONE, &n));
+        EXPECT_EQ(n, 9);
+        EXPECT_EQ(mem[0x100], 1);
+        EXPECT_EQ(mem[0x105], 6);
+        EXPECT_EQ(mem[0x202], 9);
+    }
+};
+
+TEST(tlm, vectored) {
+    tlm_vectored_harness test("vectored");
+    sc_core::sc_start();
+}
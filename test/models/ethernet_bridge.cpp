@@ -0,0 +1,239 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <thread>
+#include <chrono>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+static const mac_addr GUEST_MAC(0x52, 0x54, 0x00, 0x12, 0x34, 0x56);
+static const u8 GUEST_IP[4] = { 10, 0, 0, 15 };
+static const u8 HOST_IP[4] = { 10, 0, 0, 2 };
+static const u16 GUEST_PORT = 1234;
+
+static void put16(vector<u8>& buf, u16 val) {
+    buf.push_back(val >> 8);
+    buf.push_back(val & 0xff);
+}
+
+static u16 get16(const eth_frame& frame, size_t off) {
+    return (u16)frame[off] << 8 | frame[off + 1];
+}
+
+static u16 ip_checksum(const u8* ptr, size_t len) {
+    u32 sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2)
+        sum += (u32)ptr[i] << 8 | ptr[i + 1];
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return ~sum;
+}
+
+static eth_frame pad(vector<u8>& buf) {
+    while (buf.size() < eth_frame::FRAME_MIN_SIZE - 4)
+        buf.push_back(0);
+    return eth_frame(std::move(buf));
+}
+
+static eth_frame arp_request() {
+    vector<u8> buf(6, 0xff);
+    buf.insert(buf.end(), GUEST_MAC.bytes.begin(), GUEST_MAC.bytes.end());
+    put16(buf, eth_frame::ETHER_TYPE_ARP);
+    put16(buf, 1); // ethernet
+    put16(buf, eth_frame::ETHER_TYPE_IPV4);
+    buf.push_back(6);
+    buf.push_back(4);
+    put16(buf, 1); // request
+    buf.insert(buf.end(), GUEST_MAC.bytes.begin(), GUEST_MAC.bytes.end());
+    buf.insert(buf.end(), GUEST_IP, GUEST_IP + 4);
+    buf.insert(buf.end(), 6, 0);
+    buf.insert(buf.end(), HOST_IP, HOST_IP + 4);
+    return pad(buf);
+}
+
+static eth_frame udp_packet(const mac_addr& dest, u16 port, const string& s) {
+    vector<u8> buf(dest.bytes.begin(), dest.bytes.end());
+    buf.insert(buf.end(), GUEST_MAC.bytes.begin(), GUEST_MAC.bytes.end());
+    put16(buf, eth_frame::ETHER_TYPE_IPV4);
+
+    size_t ip = buf.size();
+    buf.push_back(0x45);
+    buf.push_back(0);
+    put16(buf, 20 + 8 + s.size());
+    put16(buf, 0);
+    put16(buf, 0x4000); // don't fragment
+    buf.push_back(64);
+    buf.push_back(eth_frame::IP_UDP);
+    put16(buf, 0);
+    buf.insert(buf.end(), GUEST_IP, GUEST_IP + 4);
+    buf.insert(buf.end(), HOST_IP, HOST_IP + 4);
+
+    u16 csum = ip_checksum(buf.data() + ip, 20);
+    buf[ip + 10] = csum >> 8;
+    buf[ip + 11] = csum & 0xff;
+
+    put16(buf, GUEST_PORT);
+    put16(buf, port);
+    put16(buf, 8 + s.size());
+    put16(buf, 0); // no udp checksum
+    buf.insert(buf.end(), s.begin(), s.end());
+    return pad(buf);
+}
+
+class bridge_bench : public test_base, public eth_host
+{
+public:
+    ethernet::bridge bridge;
+
+    eth_initiator_socket eth_tx;
+    eth_target_socket eth_rx;
+
+    vector<eth_frame> received;
+
+    bridge_bench(const sc_module_name& nm):
+        test_base(nm),
+        eth_host(),
+        bridge("bridge"),
+        eth_tx("eth_tx"),
+        eth_rx("eth_rx"),
+        received() {
+        bridge.connect(*this);
+    }
+
+    virtual void eth_receive(const eth_target_socket& sock,
+                             const eth_frame& frame) override {
+        received.push_back(frame);
+    }
+
+    // frames from slirp arrive from its host thread, so give it some real
+    // time to deliver them while the simulation keeps going
+    bool wait_for(function<bool(void)> cond) {
+        for (int i = 0; i < 1000; i++) {
+            if (cond())
+                return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            wait(1, SC_US);
+        }
+
+        return cond();
+    }
+
+    optional<mac_addr> find_arp_reply() {
+        for (const eth_frame& frame : received) {
+            if (frame.size() >= 42 && get16(frame, 12) == 0x0806 &&
+                get16(frame, 20) == 2 && !memcmp(&frame[28], HOST_IP, 4))
+                return mac_addr(frame, 22);
+        }
+
+        return std::nullopt;
+    }
+
+    optional<string> find_udp_reply() {
+        for (const eth_frame& frame : received) {
+            if (frame.size() < 42 || get16(frame, 12) != 0x0800)
+                continue;
+            if (frame[23] != eth_frame::IP_UDP)
+                continue;
+            if (get16(frame, 36) != GUEST_PORT)
+                continue;
+
+            size_t len = get16(frame, 38) - 8;
+            if (42 + len <= frame.size())
+                return string(frame.begin() + 42, frame.begin() + 42 + len);
+        }
+
+        return std::nullopt;
+    }
+
+    // guest sends a datagram to the slirp host address, which ends up on the
+    // host loopback, the answer then has to travel back through the slirp
+    // poll thread to reach the guest
+    void exchange(const string& msg) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_GE(fd, 0) << strerror(errno);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        sockaddr_in addr{};
+        socklen_t addrlen = sizeof(addr);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(fd, (sockaddr*)&addr, sizeof(addr)), 0);
+        ASSERT_EQ(getsockname(fd, (sockaddr*)&addr, &addrlen), 0);
+
+        received.clear();
+        eth_tx.send(arp_request());
+        ASSERT_TRUE(wait_for([&]() { return find_arp_reply().has_value(); }))
+            << "no arp reply from slirp";
+
+        mac_addr host = *find_arp_reply();
+        eth_tx.send(udp_packet(host, ntohs(addr.sin_port), msg));
+
+        char buf[256] = {};
+        sockaddr_in peer{};
+        socklen_t peerlen = sizeof(peer);
+        ssize_t len = -1;
+        sockaddr* peeraddr = (sockaddr*)&peer;
+        ASSERT_TRUE(wait_for([&]() {
+            len = recvfrom(fd, buf, sizeof(buf), 0, peeraddr, &peerlen);
+            return len >= 0;
+        })) << "datagram did not reach the host";
+        EXPECT_EQ(string(buf, len), msg);
+
+        string reply = "re: " + msg;
+        ASSERT_EQ(sendto(fd, reply.data(), reply.size(), 0, peeraddr, peerlen),
+                  (ssize_t)reply.size());
+        ASSERT_TRUE(wait_for([&]() { return find_udp_reply().has_value(); }))
+            << "reply did not reach the guest";
+        EXPECT_EQ(*find_udp_reply(), reply);
+
+        close(fd);
+    }
+
+    virtual void run_test() override {
+        try {
+            bridge.create_backend("slirp");
+        } catch (std::exception& ex) {
+            GTEST_SKIP() << "slirp not available: " << ex.what();
+        }
+
+        exchange("before fork");
+
+        // same sequence as system::fork_simulation, the child must get a
+        // fresh network with a running poll thread instead of the old one
+        bridge.fork_prepare();
+        fflush(nullptr);
+
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0) << "fork failed: " << strerror(errno);
+        if (pid == 0) {
+            bridge.fork_child(1);
+            exchange("after fork");
+            fflush(nullptr);
+            _exit(::testing::Test::HasFailure() ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status)) << "child crashed";
+        EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS) << "child failed";
+    }
+};
+
+TEST(ethernet, fork) {
+    bridge_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class lm75_bench : public test_base
+{
+public:
+    i2c::lm75 lm75;
+    i2c_initiator_socket i2c;
+    gpio_target_socket alarm;
+
+    lm75_bench(const sc_module_name& nm):
+        test_base(nm), lm75("lm75"), i2c("i2c"), alarm("alarm") {
+        i2c.bind(lm75.i2c);
+        lm75.alarm.bind(alarm);
+        EXPECT_STREQ(lm75.kind(), "vcml::i2c::lm75");
+    }
+
+    void command(const string& name, const vector<string>& args) {
+        stringstream ss;
+        EXPECT_TRUE(lm75.execute(name, args, ss)) << ss.str();
+        wait(SC_ZERO_TIME);
+    }
+
+    void write_config(u8 val) {
+        u8 data = i2c::lm75::REG_CONF;
+        ASSERT_EQ(i2c.start(0x48, TLM_WRITE_COMMAND), I2C_ACK);
+        ASSERT_EQ(i2c.transport(data), I2C_ACK);
+        data = val;
+        ASSERT_EQ(i2c.transport(data), I2C_ACK);
+        ASSERT_EQ(i2c.stop(), I2C_ACK);
+        wait(SC_ZERO_TIME);
+    }
+
+    double read_temp() {
+        u8 data = i2c::lm75::REG_TEMP;
+        EXPECT_EQ(i2c.start(0x48, TLM_WRITE_COMMAND), I2C_ACK);
+        EXPECT_EQ(i2c.transport(data), I2C_ACK);
+        EXPECT_EQ(i2c.stop(), I2C_ACK);
+
+        u8 hi = 0, lo = 0;
+        EXPECT_EQ(i2c.start(0x48, TLM_READ_COMMAND), I2C_ACK);
+        EXPECT_EQ(i2c.transport(hi), I2C_ACK);
+        EXPECT_EQ(i2c.transport(lo), I2C_ACK);
+        EXPECT_EQ(i2c.stop(), I2C_ACK);
+        wait(SC_ZERO_TIME);
+
+        i16 t9 = (i16)((u16)hi << 8 | lo) >> 7;
+        return t9 / 2.0;
+    }
+
+    void test_comparator() {
+        ASSERT_FALSE(alarm) << "alarm active at room temperature";
+        EXPECT_EQ(read_temp(), 22.5);
+
+        // ramp across the 80C threshold at 10C/s
+        sc_time start = sc_time_stamp();
+        command("ramp_temp", { "90", "10" });
+        wait(alarm.default_event());
+        sc_time delta = sc_time_stamp() - start;
+        EXPECT_TRUE(alarm) << "alarm did not trigger";
+        EXPECT_GE(delta, sc_time(5.7, SC_SEC)) << "alarm triggered early";
+        EXPECT_LE(delta, sc_time(5.9, SC_SEC)) << "alarm triggered late";
+        EXPECT_GE(read_temp(), 80.0);
+
+        // let the ramp settle, reading must not clear comparator alarms
+        wait(2, SC_SEC);
+        EXPECT_EQ(read_temp(), 90.0);
+        EXPECT_TRUE(alarm) << "comparator alarm cleared by read";
+
+        // threshold changes take effect immediately
+        command("set_temp_hi", { "95" });
+        EXPECT_TRUE(alarm) << "alarm cleared above hysteresis";
+        command("set_temp_lo", { "92" });
+        EXPECT_FALSE(alarm) << "alarm not cleared below hysteresis";
+        command("set_temp_lo", { "75" });
+        EXPECT_FALSE(alarm) << "alarm set below threshold";
+        command("set_temp_hi", { "80" });
+        EXPECT_TRUE(alarm) << "alarm not set above threshold";
+    }
+
+    void test_interrupt() {
+        write_config(i2c::lm75::CFG_INT);
+        EXPECT_TRUE(alarm) << "interrupt not raised above threshold";
+        read_temp();
+        EXPECT_FALSE(alarm) << "interrupt not cleared by read";
+
+        // falling below the threshold must not raise another interrupt
+        sc_time start = sc_time_stamp();
+        command("ramp_temp", { "70", "10" });
+        wait(alarm.default_event());
+        sc_time delta = sc_time_stamp() - start;
+        EXPECT_TRUE(alarm) << "interrupt not raised below hysteresis";
+        EXPECT_GE(delta, sc_time(1.4, SC_SEC)) << "interrupt raised early";
+        EXPECT_LE(delta, sc_time(1.6, SC_SEC)) << "interrupt raised late";
+        read_temp();
+        EXPECT_FALSE(alarm) << "interrupt not cleared by read";
+
+        // staying below the hysteresis keeps the interrupt quiet
+        wait(1, SC_SEC);
+        EXPECT_FALSE(alarm) << "spurious interrupt";
+        command("set_temp_hi", { "60" });
+        EXPECT_TRUE(alarm) << "interrupt not raised after lowering threshold";
+        read_temp();
+        EXPECT_FALSE(alarm) << "interrupt not cleared by read";
+    }
+
+    void test_shutdown() {
+        write_config(i2c::lm75::CFG_SHUTDOWN);
+        EXPECT_FALSE(alarm) << "alarm active during shutdown";
+        command("set_temp", { "100" });
+        EXPECT_FALSE(alarm) << "alarm triggered during shutdown";
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+        test_comparator();
+        test_interrupt();
+        test_shutdown();
+    }
+};
+
+TEST(lm75, simulate) {
+    lm75_bench bench("bench");
+    sc_core::sc_start();
+}
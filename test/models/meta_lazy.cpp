@@ -0,0 +1,79 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class lazy_test : public test_base
+{
+public:
+    tlm_initiator_socket out_used;
+    tlm_initiator_socket out_unused;
+
+    meta::lazy used;
+    meta::lazy unused;
+
+    lazy_test(const sc_module_name& nm):
+        test_base(nm),
+        out_used("out_used"),
+        out_unused("out_unused"),
+        used("used", "vcml::generic::memory 0x1000"),
+        unused("unused", "vcml::generic::memory 0x1000") {
+        out_used.bind(used.in);
+        out_unused.bind(unused.in);
+
+        clk.bind(used.clk);
+        clk.bind(unused.clk);
+        rst.bind(used.rst);
+        rst.bind(unused.rst);
+    }
+
+    virtual void run_test() override {
+        ASSERT_TRUE(used.is_built());
+        ASSERT_FALSE(unused.is_built());
+        ASSERT_NE(used.wrapped_model(), nullptr);
+
+        u32 val = 0;
+        EXPECT_OK(out_used.writew<u32>(0x10, 0x1234));
+        EXPECT_OK(out_used.readw(0x10, val));
+        EXPECT_EQ(val, 0x1234);
+
+        // accessing the missing model records it and stops the simulation,
+        // which test_base will then attempt a second time
+        sc_report_handler::set_actions(SC_ID_SIMULATION_STOP_CALLED_TWICE_,
+                                       SC_DO_NOTHING);
+        EXPECT_FALSE(is_stop_requested());
+        EXPECT_AE(out_unused.writew<u32>(0x10, 0x1234));
+        EXPECT_TRUE(is_stop_requested());
+
+        // only the proxy that saw traffic is recorded
+        std::ifstream usage(used.usage.get());
+        string line;
+        vector<string> names;
+        while (std::getline(usage, line))
+            names.push_back(line);
+        EXPECT_EQ(names.size(), 2);
+        EXPECT_TRUE(stl_contains(names, string("test.used")));
+        EXPECT_TRUE(stl_contains(names, string("test.unused")));
+    }
+};
+
+TEST(lazy, simulate) {
+    string file = mkstr("/tmp/vcml_lazy_test_%d", (int)mwr::getpid());
+    std::ofstream(file) << "test.used" << std::endl;
+
+    vcml::broker broker("test");
+    broker.define("test.used.usage", file);
+    broker.define("test.unused.usage", file);
+
+    lazy_test stim("test");
+    sc_core::sc_start();
+
+    std::remove(file.c_str());
+}
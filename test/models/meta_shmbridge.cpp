@@ -0,0 +1,256 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#ifdef MWR_LINUX
+#include <sys/wait.h>
+#endif
+
+class shmbridge_test : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    gpio_initiator_socket irq_out;
+    gpio_target_socket irq_in;
+
+    meta::shmbridge_target target;
+    meta::shmbridge_initiator initiator;
+    generic::memory mem;
+
+    shmbridge_test(const sc_module_name& nm):
+        test_base(nm),
+        out("out"),
+        irq_out("irq_out"),
+        irq_in("irq_in"),
+        target("target"),
+        initiator("initiator"),
+        mem("mem", 0x1000) {
+        out.bind(target.in);
+        initiator.out.bind(mem.in);
+
+        irq_out.bind(target.gpio_in[0]);
+        initiator.gpio_out[0].bind(irq_in);
+
+        clk.bind(target.clk);
+        clk.bind(initiator.clk);
+        clk.bind(mem.clk);
+
+        rst.bind(target.rst);
+        rst.bind(initiator.rst);
+        rst.bind(mem.rst);
+    }
+
+    virtual void run_test() override {
+        // both sides live in this process, so everything is served inline
+        ASSERT_OK(out.writew<u32>(0x10, 0x11223344));
+        EXPECT_EQ(mem[0x10], 0x44);
+        EXPECT_EQ(mem[0x13], 0x11);
+
+        u32 val = 0;
+        ASSERT_OK(out.readw(0x10, val));
+        EXPECT_EQ(val, 0x11223344);
+
+        // transfers larger than a message get split up
+        vector<u8> buf(1000);
+        for (size_t i = 0; i < buf.size(); i++)
+            buf[i] = (u8)i;
+        ASSERT_OK(out.write(0x100, buf.data(), buf.size()));
+        EXPECT_EQ(memcmp(mem.data() + 0x100, buf.data(), buf.size()), 0);
+
+        // shared memory on the initiator side is exported through dmi
+        u8* ptr = out.lookup_dmi_ptr(0x10, 4, VCML_ACCESS_READ_WRITE);
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_NE(ptr, mem.data() + 0x10);
+        ptr[0] = 0xab;
+        EXPECT_EQ(mem[0x10], 0xab);
+
+        // gpios are delivered once the bridges synchronize
+        irq_out = true;
+        wait(2 * tlm::tlm_global_quantum::instance().get());
+        EXPECT_TRUE(irq_in.read());
+        irq_out = false;
+        wait(2 * tlm::tlm_global_quantum::instance().get());
+        EXPECT_FALSE(irq_in.read());
+    }
+};
+
+#ifdef MWR_LINUX
+// One half of a two-process setup: the target bridge forwards to the peer
+// memory and the initiator bridge serves the peer's requests to our memory.
+class shmbridge_peer : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    gpio_initiator_socket irq_out;
+    gpio_target_socket irq_in;
+
+    meta::shmbridge_target target;
+    meta::shmbridge_initiator initiator;
+    generic::memory mem;
+
+    const u32 mine;
+    const u32 peers;
+
+    shmbridge_peer(const sc_module_name& nm, bool first):
+        test_base(nm),
+        out("out"),
+        irq_out("irq_out"),
+        irq_in("irq_in"),
+        target("target"),
+        initiator("initiator"),
+        mem("mem", 0x4000),
+        mine(first ? 0xaaaaaaaa : 0xbbbbbbbb),
+        peers(first ? 0xbbbbbbbb : 0xaaaaaaaa) {
+        out.bind(target.in);
+        initiator.out.bind(mem.in);
+
+        irq_out.bind(target.gpio_in[0]);
+        initiator.gpio_out[0].bind(irq_in);
+
+        clk.bind(target.clk);
+        clk.bind(initiator.clk);
+        clk.bind(mem.clk);
+
+        rst.bind(target.rst);
+        rst.bind(initiator.rst);
+        rst.bind(mem.rst);
+    }
+
+    u32 peek(u64 addr) const {
+        u32 val = 0;
+        memcpy(&val, mem.data() + addr, sizeof(val));
+        return val;
+    }
+
+    // both processes run the same phases, aligned to absolute times
+    void wait_until(const sc_time& t) {
+        sync();
+        ASSERT_LE(sc_time_stamp(), t) << "phase overran";
+        wait(t - sc_time_stamp());
+    }
+
+    virtual void run_test() override {
+        const sc_time quantum = tlm::tlm_global_quantum::instance().get();
+
+        // the first access takes the peer memory read latency
+        u32 val = 0;
+        sc_time start = local_time_stamp();
+        ASSERT_OK(out.readw(0x100, val));
+        EXPECT_EQ(local_time_stamp() - start, sc_time(100, SC_NS));
+        ASSERT_OK(out.writew(0x100, mine));
+
+        u8* ptr = out.lookup_dmi_ptr(0x200, 4, VCML_ACCESS_READ_WRITE);
+        ASSERT_NE(ptr, nullptr);
+        memcpy(ptr, &mine, sizeof(mine));
+
+        wait_until(10 * quantum);
+        EXPECT_EQ(peek(0x100), peers);
+        EXPECT_EQ(peek(0x200), peers);
+
+        // both sides request at once, so each one has to serve the other
+        // one while waiting for its own responses
+        vector<u8> buf(0x1000), cmp(0x1000);
+        for (int i = 0; i < 10; i++) {
+            for (size_t j = 0; j < buf.size(); j++)
+                buf[j] = (u8)(i + j + mine);
+            ASSERT_OK(out.write(0x1000, buf.data(), buf.size(), SBI_NODMI));
+            ASSERT_OK(out.read(0x1000, cmp.data(), cmp.size(), SBI_NODMI));
+            EXPECT_EQ(buf, cmp);
+        }
+
+        // peers never drift apart more than one sync interval plus the
+        // interval it took the peer to publish its time
+        wait_until(50 * quantum);
+        for (int i = 0; i < 20; i++) {
+            u64 now = sc_time_stamp().value();
+            memcpy(mem.data(), &now, sizeof(now));
+            wait(quantum);
+
+            u64 peer = 0;
+            ASSERT_OK(out.readw(0x0, peer));
+            EXPECT_LE(time_from_value(peer), sc_time_stamp() + 3 * quantum);
+            EXPECT_GE(time_from_value(peer) + 3 * quantum, sc_time_stamp());
+        }
+
+        // more gpio updates than ring slots, post must wait for the peer
+        wait_until(80 * quantum);
+        for (int i = 0; i < 129; i++)
+            irq_out ^= true;
+
+        wait_until(90 * quantum);
+        EXPECT_TRUE(irq_in.read());
+        EXPECT_TRUE(target.is_connected());
+        EXPECT_TRUE(initiator.is_connected());
+
+        wait_until(100 * quantum);
+    }
+};
+
+static int run_peer(const string& base, bool first) {
+    vcml::broker broker("test");
+    string ab = base + "_ab", ba = base + "_ba";
+    broker.define("peer.target.channel", first ? ab : ba);
+    broker.define("peer.initiator.channel", first ? ba : ab);
+    broker.define("peer.mem.shared", "/" + base + (first ? "_a" : "_b"));
+    broker.define("peer.mem.read_latency", "10");
+
+    {
+        shmbridge_peer peer("peer", first);
+        sc_core::sc_start();
+    }
+
+    return ::testing::Test::HasFailure() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// must run before anything gets elaborated in this process, since both
+// peers simulate in their own child process
+TEST(shmbridge, fork) {
+    tlm::tlm_global_quantum::instance().set(sc_time(1.0, SC_US));
+    string base = mkstr("vcml_shmbridge_fork_%d", (int)mwr::getpid());
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t children[2];
+    for (int i = 0; i < 2; i++) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0) << "fork failed: " << strerror(errno);
+        if (pid == 0) {
+            int code = run_peer(base, i == 0);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(code);
+        }
+
+        children[i] = pid;
+    }
+
+    for (pid_t pid : children) {
+        int status = 0;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        EXPECT_TRUE(WIFEXITED(status)) << "peer " << pid << " crashed";
+        EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS) << "peer " << pid;
+    }
+}
+#endif
+
+TEST(shmbridge, simulate) {
+    tlm::tlm_global_quantum::instance().set(sc_time(1.0, SC_US));
+
+    vcml::broker broker("test");
+    string channel = mkstr("vcml_shmbridge_test_%d", (int)mwr::getpid());
+    broker.define("test.target.channel", channel);
+    broker.define("test.initiator.channel", channel);
+    broker.define("test.mem.shared", "/" + channel + "_mem");
+
+    shmbridge_test stim("test");
+    sc_core::sc_start();
+}
@@ -90,6 +90,18 @@ public:
         ASSERT_OK(out.writew(0x4, 0u)) << "cannot write msip1";
         wait(SC_ZERO_TIME);
         ASSERT_FALSE(irq_sw_1.read()) << "IRQ_TIMER_1 not cleared";
+
+        // mtime reads must include the quantum offset of the initiator
+        tlm::tlm_global_quantum::instance().set(clock_cycles(1000));
+        u64 mtime2;
+        ASSERT_OK(out.readw(0xbff8, mtime)) << "cannot read mtime";
+        local_time() = clock_cycles(100);
+        ASSERT_OK(out.readw(0xbff8, mtime2)) << "cannot read mtime";
+        ASSERT_EQ(mtime2, mtime + 100) << "mtime ignores local time";
+        ASSERT_EQ(local_time(), clock_cycles(100)) << "mtime read synced";
+        sync();
+        ASSERT_OK(out.readw(0xbff8, mtime)) << "cannot read mtime";
+        ASSERT_EQ(mtime, mtime2) << "mtime inconsistent after sync";
     }
 };
 
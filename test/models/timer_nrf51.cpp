@@ -124,6 +124,30 @@ public:
         ASSERT_OK(out.writew<u32>(nrf51_capture(1), 1));
         ASSERT_OK(out.readw<u32>(nrf51_cc(1), data));
         ASSERT_EQ(data, 5);
+
+        // compare reads must account for the quantum offset
+        tlm::tlm_global_quantum::instance().set(sc_time(1.0, SC_MS));
+        ASSERT_OK(out.writew<u32>(NRF51_MODE, 0));
+        ASSERT_OK(out.writew<u32>(NRF51_CLEAR, 1));
+        ASSERT_OK(out.writew<u32>(nrf51_cc(0), 100)); // 100us at 1 MHz
+        ASSERT_OK(out.writew<u32>(nrf51_compare(0), 0));
+        ASSERT_OK(out.writew<u32>(NRF51_START, 1));
+        local_time() = sc_time(50.0, SC_US);
+        ASSERT_OK(out.readw<u32>(nrf51_compare(0), data));
+        ASSERT_EQ(data, 0);
+        local_time() = sc_time(150.0, SC_US);
+        ASSERT_OK(out.readw<u32>(nrf51_compare(0), data));
+        ASSERT_EQ(data, 1);
+        ASSERT_FALSE(irq);
+
+        // a stopped timer must not report events from its stale start time
+        local_time() = SC_ZERO_TIME;
+        ASSERT_OK(out.writew<u32>(NRF51_STOP, 1));
+        local_time() = sc_time(150.0, SC_US);
+        ASSERT_OK(out.readw<u32>(nrf51_compare(0), data));
+        ASSERT_EQ(data, 0);
+        sync();
+        ASSERT_FALSE(irq);
     }
 };
 
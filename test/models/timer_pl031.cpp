@@ -50,6 +50,8 @@ public:
         test_time_date();
         wait(SC_ZERO_TIME);
         test_alarm_irq();
+        wait(SC_ZERO_TIME);
+        test_local_time();
     }
 
     constexpr u64 pl031_pid(size_t i) { return 0xfe0 + i * 4; }
@@ -132,6 +134,19 @@ public:
         ASSERT_OK(out.readw(PL031_RIS, data));
         EXPECT_EQ(data, 0);
     }
+
+    void test_local_time() {
+        u32 data, data2;
+        tlm::tlm_global_quantum::instance().set(sc_time(10.0, SC_SEC));
+        ASSERT_OK(out.readw(PL031_DR, data));
+        local_time() = sc_time(5.0, SC_SEC);
+        ASSERT_OK(out.readw(PL031_DR, data2));
+        EXPECT_EQ(data2 - data, 5);
+        EXPECT_EQ(local_time(), sc_time(5.0, SC_SEC));
+        sync();
+        ASSERT_OK(out.readw(PL031_DR, data));
+        EXPECT_EQ(data, data2);
+    }
 };
 
 TEST(timer, pl031) {
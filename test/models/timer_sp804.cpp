@@ -81,6 +81,27 @@ public:
         val = 0;
         EXPECT_OK(out.readw(TIMER1_CONTROL, val)) << "cannot read CONTROL";
         EXPECT_EQ(val, 0x20) << "TIMER1_CONTROL did not reset";
+
+        // reads must account for the quantum offset of the initiator
+        tlm::tlm_global_quantum::instance().set(sc_time(1.0, SC_MS));
+        EXPECT_OK(out.writew(TIMER1_LOAD, 0x1000u)) << "cannot set counter";
+        val = timers::sp804::timer::CONTROL_ENABLED |
+              timers::sp804::timer::CONTROL_ONESHOT |
+              timers::sp804::timer::CONTROL_32BIT;
+        EXPECT_OK(out.writew(TIMER1_CONTROL, val)) << "cannot write CONTROL";
+
+        EXPECT_OK(out.readw(TIMER1_VALUE, val)) << "cannot read counter";
+        EXPECT_EQ(val, 0x1000) << "counter changed without time passing";
+
+        local_time() = clock_cycles(0x40);
+        EXPECT_OK(out.readw(TIMER1_VALUE, val)) << "cannot read counter";
+        EXPECT_EQ(val, 0x1000 - 0x40) << "counter ignores local time";
+        EXPECT_EQ(local_time(), clock_cycles(0x40)) << "local time changed";
+
+        local_time() = clock_cycles(0x2000);
+        EXPECT_OK(out.readw(TIMER1_VALUE, val)) << "cannot read counter";
+        EXPECT_EQ(val, 0) << "counter did not saturate past its deadline";
+        sync();
     }
 };
 
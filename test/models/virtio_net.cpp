@@ -23,7 +23,9 @@ public:
     gpio_target_socket irq;
 
     static constexpr u64
-        EXPECTED_FEATURES = virtio::net::VIRTIO_NET_F_MTU |
+        EXPECTED_FEATURES = virtio::net::VIRTIO_NET_F_CSUM |
+                            virtio::net::VIRTIO_NET_F_GUEST_CSUM |
+                            virtio::net::VIRTIO_NET_F_MTU |
                             virtio::net::VIRTIO_NET_F_MAC |
                             virtio::net::VIRTIO_NET_F_STATUS |
                             virtio::net::VIRTIO_NET_F_CTRL_VQ |
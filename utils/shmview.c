@@ -0,0 +1,225 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "vcml/ui/shmfb.h"
+
+struct viewer {
+    struct vcml_shmfb_header *hdr;
+    size_t hdr_size;
+    const uint8_t *fb;
+    void *fb_map;
+    size_t fb_map_size;
+};
+
+void print_usage(const char *name) {
+    fprintf(stderr, "Usage: %s <display> [outdir]\n", name);
+    fprintf(stderr, "Follows the framebuffer of display shm:<display> and "
+                    "writes each frame as PPM into outdir\n");
+}
+
+void *map_segment(const char *name, size_t *size) {
+    struct stat st;
+    void *ptr;
+
+    int fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    ptr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+        return NULL;
+
+    *size = st.st_size;
+    return ptr;
+}
+
+void viewer_close(struct viewer *v) {
+    if (v->fb_map)
+        munmap(v->fb_map, v->fb_map_size);
+    if (v->hdr)
+        munmap(v->hdr, v->hdr_size);
+    memset(v, 0, sizeof(*v));
+}
+
+int viewer_open(struct viewer *v, const char *name) {
+    struct vcml_shmfb_header *hdr;
+
+    memset(v, 0, sizeof(*v));
+    v->hdr = map_segment(name, &v->hdr_size);
+    if (v->hdr == NULL)
+        return -1;
+
+    hdr = v->hdr;
+    if (hdr->magic != VCML_SHMFB_MAGIC || hdr->version != VCML_SHMFB_VERSION ||
+        __atomic_load_n(&hdr->state, __ATOMIC_ACQUIRE) != VCML_SHMFB_ACTIVE) {
+        viewer_close(v);
+        return -1;
+    }
+
+    if (hdr->fb_name[0] == '\0') {
+        v->fb = (const uint8_t *)hdr + hdr->fb_offset;
+        return 0;
+    }
+
+    v->fb_map = map_segment(hdr->fb_name, &v->fb_map_size);
+    if (v->fb_map == NULL ||
+        hdr->fb_offset + hdr->fb_size > v->fb_map_size) {
+        viewer_close(v);
+        return -1;
+    }
+
+    v->fb = (const uint8_t *)v->fb_map + hdr->fb_offset;
+    return 0;
+}
+
+void viewer_wait(struct viewer *v, uint32_t seen) {
+    struct timespec timeout = { 1, 0 };
+    __atomic_add_fetch(&v->hdr->waiters, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &v->hdr->seq, FUTEX_WAIT, seen, &timeout, NULL, 0);
+    __atomic_sub_fetch(&v->hdr->waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+uint8_t channel(uint32_t pixel, struct vcml_shmfb_channel ch) {
+    uint32_t val;
+    if (ch.size == 0)
+        return 0;
+
+    val = (pixel >> ch.offset) & ((1u << ch.size) - 1);
+    return (uint8_t)((val * 255) / ((1u << ch.size) - 1));
+}
+
+int write_ppm(const struct viewer *v, const char *dir, uint32_t frame) {
+    const struct vcml_shmfb_header *hdr = v->hdr;
+    char path[4096];
+    uint32_t x, y, i;
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/frame_%06u.ppm", dir, frame);
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    fprintf(f, "P6\n%u %u\n255\n", hdr->xres, hdr->yres);
+    for (y = 0; y < hdr->yres; y++) {
+        for (x = 0; x < hdr->xres; x++) {
+            const uint8_t *src = v->fb + y * hdr->stride + x * hdr->bpp;
+            uint32_t pixel = 0;
+            uint8_t rgb[3];
+
+            for (i = 0; i < hdr->bpp; i++) {
+                uint32_t shift = hdr->big_endian ? hdr->bpp - 1 - i : i;
+                pixel |= (uint32_t)src[i] << (shift * 8);
+            }
+
+            rgb[0] = channel(pixel, hdr->r);
+            rgb[1] = channel(pixel, hdr->g);
+            rgb[2] = channel(pixel, hdr->b);
+            fwrite(rgb, 1, sizeof(rgb), f);
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    struct viewer v;
+    uint32_t frame = 0;
+    char name[64];
+
+    if (argc < 2 || argc > 3) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *outdir = argc > 2 ? argv[2] : NULL;
+    snprintf(name, sizeof(name), VCML_SHMFB_NAME, atoi(argv[1]));
+
+    while (1) {
+        uint32_t seen;
+
+        if (viewer_open(&v, name) < 0) {
+            usleep(100000);
+            continue;
+        }
+
+        printf("attached to %s: %ux%u, %u bytes per pixel%s\n", name,
+               v.hdr->xres, v.hdr->yres, v.hdr->bpp,
+               v.hdr->fb_name[0] ? ", zero-copy" : "");
+
+        /* treat everything as damaged on attach */
+        seen = __atomic_load_n(&v.hdr->seq, __ATOMIC_ACQUIRE) -
+               VCML_SHMFB_DAMAGE - 1;
+
+        while (__atomic_load_n(&v.hdr->state, __ATOMIC_ACQUIRE) ==
+               VCML_SHMFB_ACTIVE) {
+            uint32_t seq = __atomic_load_n(&v.hdr->seq, __ATOMIC_ACQUIRE);
+            uint32_t x0 = 0, y0 = 0, x1 = v.hdr->xres, y1 = v.hdr->yres;
+            uint32_t i;
+
+            if (seq == seen) {
+                viewer_wait(&v, seen);
+                continue;
+            }
+
+            if (seq - seen <= VCML_SHMFB_DAMAGE) {
+                x0 = v.hdr->xres;
+                y0 = v.hdr->yres;
+                x1 = y1 = 0;
+                for (i = seen; i != seq; i++) {
+                    struct vcml_shmfb_rect r;
+                    r = v.hdr->damage[i % VCML_SHMFB_DAMAGE];
+                    if (r.w == 0 || r.h == 0)
+                        continue;
+                    x0 = r.x < x0 ? r.x : x0;
+                    y0 = r.y < y0 ? r.y : y0;
+                    x1 = r.x + r.w > x1 ? r.x + r.w : x1;
+                    y1 = r.y + r.h > y1 ? r.y + r.h : y1;
+                }
+            }
+
+            seen = seq;
+            if (x1 <= x0 || y1 <= y0)
+                continue;
+
+            printf("frame %u: damage %ux%u at %u,%u\n", frame, x1 - x0,
+                   y1 - y0, x0, y0);
+            if (outdir != NULL)
+                write_ppm(&v, outdir, frame);
+            frame++;
+        }
+
+        printf("detached from %s\n", name);
+        viewer_close(&v);
+    }
+
+    return EXIT_SUCCESS;
+}